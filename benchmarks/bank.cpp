@@ -0,0 +1,73 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "bench.h"
+#include "core.h"
+
+// The same branch light loop on N cpus with different data: each cpu6502
+// run on its own, against a cpu6502_bank<N> running the lanes in lockstep.
+
+namespace {
+
+constexpr std::size_t runs = 200;
+
+// loop: TXA; ASL A; ADC #$1d; EOR $10; STA $10; INX; DEY; BNE loop; HLT
+// With Y starting at 0, 256 times round: 2048 instructions.
+const std::vector<byte> program = {0x8a, 0x0a, 0x69, 0x1d, 0x45, 0x10, 0x85,
+                                   0x10, 0xe8, 0x88, 0xd0, 0xf5, 0x02};
+constexpr double instructions = 256 * 8;
+
+auto reset(cpu6502& cpu, std::size_t lane) -> void {
+  cpu.PC = 0x1000;
+  cpu.X = static_cast<byte>(lane * 37);
+  cpu.Y = 0x00;
+  cpu.write(0x10, static_cast<byte>(lane));
+}
+
+template <std::size_t N>
+auto run() -> void {
+  std::vector<std::unique_ptr<cpu6502>> cpus;
+  auto bank = std::make_unique<cpu6502_bank<N>>();
+  for (std::size_t i = 0; i < N; i++) {
+    cpus.push_back(std::make_unique<cpu6502>());
+    for (auto* cpu : {cpus.back().get(), &bank->lane(i)}) {
+      cpu->load(0x1000, program.data(), program.size());
+    }
+  }
+
+  auto scalar = measure(runs, [&] {
+    for (std::size_t i = 0; i < N; i++) {
+      reset(*cpus[i], i);
+      cpus[i]->exec_until_hlt();
+    }
+    do_not_optimize(cpus);
+  });
+
+  auto lockstep = measure(runs, [&] {
+    for (std::size_t i = 0; i < N; i++) {
+      reset(bank->lane(i), i);
+    }
+    bank->exec_until_hlt();
+    do_not_optimize(bank);
+  });
+
+  auto mips = [](double ns) { return N * instructions / ns * 1e3; };
+  fmt::print("{:>2} lanes {:>16.1f} MIPS separately {:>8.1f} MIPS banked "
+             "{:>6.2f}x\n",
+             N, mips(scalar), mips(lockstep), scalar / lockstep);
+}
+
+}  // namespace
+
+auto main() -> int {
+  run<1>();
+  run<4>();
+  run<8>();
+  run<16>();
+  run<32>();
+
+  return 0;
+}
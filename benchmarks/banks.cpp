@@ -0,0 +1,104 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bench.h"
+#include "core.h"
+
+// A loop that switches the bank of a 16 KB window, then reads 256 bytes
+// from it. Bank switching through window_mapper, which rewrites the page
+// table, against a mapper that resolves the bank on every access with a
+// virtual call, and against the same loop on flat memory with no banking.
+
+namespace {
+
+constexpr std::size_t runs = 20;
+constexpr int instructions = 1'000'000;
+constexpr std::size_t accesses = 1 << 20;
+
+constexpr std::size_t rom_banks = 8;
+
+// INX; STX $c000; LDA $8000,Y; INY; BNE -6; JMP $1000
+constexpr std::initializer_list<byte> program = {
+    0xe8, 0x8e, 0x00, 0xc0, 0xb9, 0x00, 0x80, 0xc8, 0xd0, 0xfa, 0x4c, 0x00,
+    0x10};
+
+auto banked_rom() -> rom_image {
+  std::vector<byte> bytes(rom_banks * window_mapper::bank_size);
+  for (std::size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<byte>(i / window_mapper::bank_size);
+  }
+  return rom_image(std::move(bytes));
+}
+
+// The window and its register as one device: every read looks the bank up.
+class device_mapper : public bus_device {
+ public:
+  explicit device_mapper(rom_image rom) : m_rom(std::move(rom)) {}
+
+  auto read(word addr) -> byte override {
+    return m_rom.data()[m_bank * window_mapper::bank_size + (addr & 0x3fff)];
+  }
+
+  auto write(word /*addr*/, byte data) -> void override {
+    m_bank = data % rom_banks;
+  }
+
+ private:
+  rom_image m_rom;
+  std::size_t m_bank = 0;
+};
+
+template <typename Cpu>
+auto mips(const char* name, Cpu& cpu) -> void {
+  cpu.load_program(program);
+
+  auto ns = measure(runs, [&] {
+    cpu.PC = 0x1000;
+    cpu.exec_n(instructions);
+    do_not_optimize(cpu);
+  });
+
+  fmt::print("{:<40} {:>14.2f} MIPS\n", name, instructions / ns * 1000);
+}
+
+auto reads(const char* name, const paged_memory& memory) -> void {
+  report(name, measure(runs, [&] {
+                 byte sum = 0;
+                 for (std::size_t i = 0; i < accesses; i++) {
+                   sum += memory.read(static_cast<word>(0x8000 + (i & 0x3fff)));
+                 }
+                 do_not_optimize(sum);
+               }) / accesses);
+}
+
+}  // namespace
+
+auto main() -> int {
+  auto flat = std::make_unique<cpu6502>();
+  mips("flat_memory, no banking", *flat);
+
+  auto paged = std::make_unique<bus_cpu6502>();
+  window_mapper mapper(paged->memory, banked_rom(), 0, {0x80}, 0xc0);
+  mips("window_mapper", *paged);
+
+  auto virtual_paged = std::make_unique<bus_cpu6502>();
+  device_mapper device(banked_rom());
+  virtual_paged->memory.map_device(0x80, window_mapper::bank_pages, device);
+  virtual_paged->memory.map_device(0xc0, 1, device);
+  mips("virtual call per access", *virtual_paged);
+
+  reads("read, window_mapper", paged->memory);
+  reads("read, virtual call per access", virtual_paged->memory);
+
+  std::size_t bank = 0;
+  report("switch, window_mapper", measure(accesses, [&] {
+           mapper.select(0, bank++);
+           do_not_optimize(paged->memory);
+         }));
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include <fmt/base.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// run_batch() over many short fib jobs, for 1, 2, 4... threads up to twice
+// the hardware threads.
+
+namespace {
+
+constexpr std::size_t jobs = 4096;
+constexpr std::size_t runs = 3;
+
+// fib stopping at page 0x14: about 9000 instructions.
+constexpr byte till = 0x14;
+
+// Program size of fib, up to and including its HLT.
+constexpr std::size_t fib_size = fib_hlt - 0x1000 + 1;
+
+}  // namespace
+
+auto main() -> int {
+  auto loaded = std::make_unique<cpu6502>();
+  load_fib(*loaded, till);
+
+  std::vector<batch_job> batch(jobs);
+  for (auto& job : batch) {
+    job.program = &loaded->memory.bytes[0x1000];
+    job.size = fib_size;
+  }
+  std::vector<batch_result> results(jobs);
+
+  auto hardware = std::max(1U, std::thread::hardware_concurrency());
+  double single = 0;
+
+  for (unsigned threads = 1; threads <= 2 * hardware; threads *= 2) {
+    auto ns = measure(runs, [&] {
+      run_batch(batch.data(), batch.size(), results.data(), threads);
+      do_not_optimize(results);
+    });
+
+    single = threads == 1 ? ns : single;
+    fmt::print("{:>2} threads {:>29.0f} jobs/s {:>8.2f}x\n", threads,
+               jobs / ns * 1e9, single / ns);
+  }
+
+  fmt::print("{} hardware threads, {} instructions per job\n", hardware,
+             results[0].instructions);
+
+  return 0;
+}
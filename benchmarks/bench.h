@@ -0,0 +1,41 @@
+#ifndef CONSTEXPR_6502_BENCHMARKS_BENCH_H
+#define CONSTEXPR_6502_BENCHMARKS_BENCH_H
+
+#include <fmt/base.h>
+
+#include <chrono>
+#include <cstddef>
+
+// Keeps the optimizer from discarding a value that is only computed for
+// timing purposes. Takes the address: an "m" operand for a whole cpu makes
+// GCC copy all of it to the stack first.
+template <typename T>
+inline auto do_not_optimize(T const& value) -> void {
+  asm volatile("" : : "r"(&value) : "memory");  // NOLINT(hicpp-no-assembler)
+}
+
+// Runs `func` `iterations` times and returns the mean wall time of a single
+// call in nanoseconds.
+template <typename F>
+auto measure(std::size_t iterations, F&& func) -> double {
+  auto begin = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < iterations; i++) {
+    func();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration<double, std::nano>(end - begin);
+
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+inline auto report(const char* name, double ns) -> void {
+  fmt::print("{:<40} {:>14.2f} ns\n", name, ns);
+}
+
+inline auto report_bytes(const char* name, std::size_t bytes) -> void {
+  fmt::print("{:<40} {:>14} B\n", name, bytes);
+}
+
+#endif
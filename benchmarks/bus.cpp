@@ -0,0 +1,77 @@
+#include <fmt/base.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// paged_memory against flat_memory: fib throughput, and the cost of a read
+// through RAM, ROM and device pages.
+
+namespace {
+
+constexpr std::size_t runs = 20;
+constexpr std::size_t accesses = 1 << 20;
+
+class counter_device : public bus_device {
+ public:
+  auto read(word /*addr*/) -> byte override { return value++; }
+  auto write(word /*addr*/, byte data) -> void override { value = data; }
+
+  byte value = 0;
+};
+
+template <typename Cpu>
+auto mips(const char* name) -> void {
+  std::uint64_t instructions = 0;
+  auto ns = measure(runs, [&] {
+    auto cpu = std::make_unique<Cpu>();
+    load_fib(*cpu);
+
+    instructions = 0;
+    while (cpu->read(cpu->PC) != hlt) {
+      cpu->exec();
+      instructions++;
+    }
+
+    do_not_optimize(*cpu);
+  });
+
+  fmt::print("{:<40} {:>14.2f} MIPS\n", name,
+             static_cast<double>(instructions) / ns * 1000);
+}
+
+template <typename Memory>
+auto reads(const char* name, const Memory& memory, word base) -> void {
+  report(name, measure(runs, [&] {
+                 byte sum = 0;
+                 for (std::size_t i = 0; i < accesses; i++) {
+                   sum += memory.read(static_cast<word>(base + (i & 0xff)));
+                 }
+                 do_not_optimize(sum);
+               }) / accesses);
+}
+
+}  // namespace
+
+auto main() -> int {
+  mips<cpu6502>("fib, flat_memory");
+  mips<bus_cpu6502>("fib, paged_memory");
+
+  auto flat = std::make_unique<flat_memory>();
+  reads("read, flat_memory", *flat, 0x2000);
+
+  static std::array<byte, 0x100> rom{};
+  counter_device device;
+  paged_memory paged;
+  paged.map_rom(0xe0, 1, rom.data());
+  paged.map_device(0xd0, 1, device);
+
+  reads("read, paged_memory RAM", paged, 0x2000);
+  reads("read, paged_memory ROM", paged, 0xe000);
+  reads("read, paged_memory device", paged, 0xd000);
+
+  return 0;
+}
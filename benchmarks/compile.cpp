@@ -0,0 +1,32 @@
+#include <fmt/format.h>
+
+#include <string>
+
+#include "bench.h"
+#include "compile.h"
+
+// Compile time and peak compiler memory of examples/fib.cpp, which runs fib
+// in the constant evaluator, for a few values of `till`. Each is built with
+// GCC's default constexpr limits and with raised ones; "failed" under the
+// defaults means the run needs the raised limits.
+//
+// Then benchmarks/constexpr.cpp once per memory model.
+
+auto main() -> int {
+  for (int till : {0x14, 0x18, 0x20, 0x30, 0x40}) {
+    auto define = fmt::format("-DFIB_TILL={:#04x}", till);
+
+    report_compile(fmt::format("fib.cpp till {:#04x}", till),
+                   compile("examples/fib.cpp", {define}));
+
+    auto flags = raised_limits;
+    flags.push_back(define);
+    report_compile(fmt::format("fib.cpp till {:#04x}, raised limits", till),
+                   compile("examples/fib.cpp", flags));
+  }
+
+  report_compile("constexpr.cpp", compile("benchmarks/constexpr.cpp",
+                                           raised_limits));
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef CONSTEXPR_6502_BENCHMARKS_COMPILE_H
+#define CONSTEXPR_6502_BENCHMARKS_COMPILE_H
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fmt/base.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Compiles `file`, relative to the project root, with the compiler the
+// project was configured with (BENCH_CXX in CMakeLists.txt) and `flags`
+// appended. Used to time the constant evaluator, which does all its work at
+// compile time.
+
+struct compile_result {
+  double ms;
+  long peak_rss_kb;
+  bool ok;
+};
+
+// GCC's limits, high enough for any run these benchmarks do.
+inline const std::vector<std::string> raised_limits = {
+    "-fconstexpr-ops-limit=4294967296", "-fconstexpr-loop-limit=2147483647"};
+
+inline auto compile(const char* file, const std::vector<std::string>& flags)
+    -> compile_result {
+  std::vector<std::string> args = {BENCH_CXX, "-std=c++17", "-fsyntax-only",
+                                   "-I" BENCH_ROOT_DIR "/src",
+                                   "-I" BENCH_ROOT_DIR "/benchmarks"};
+  args.insert(args.end(), flags.begin(), flags.end());
+  args.emplace_back(std::string(BENCH_ROOT_DIR "/") + file);
+
+  std::vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  for (auto& arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  auto begin = std::chrono::steady_clock::now();
+
+  auto pid = fork();
+  if (pid == 0) {
+    // Errors from runs that fail a limit would drown the report.
+    dup2(open("/dev/null", O_WRONLY), STDERR_FILENO);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+
+  int status = 0;
+  rusage usage{};
+  wait4(pid, &status, 0, &usage);
+
+  auto end = std::chrono::steady_clock::now();
+
+  return {std::chrono::duration<double, std::milli>(end - begin).count(),
+          usage.ru_maxrss, WIFEXITED(status) && WEXITSTATUS(status) == 0};
+}
+
+inline auto report_compile(const std::string& name, const compile_result& r)
+    -> void {
+  if (!r.ok) {
+    fmt::print("{:<40} {:>14}\n", name, "failed");
+    return;
+  }
+
+  fmt::print("{:<40} {:>14.0f} ms {:>10} KB\n", name, r.ms, r.peak_rss_kb);
+}
+
+#endif
@@ -0,0 +1,35 @@
+// Not run, only compiled: the compile time of this file is the cost of
+// running fib in the constant evaluator. bench_until builds it once per stop
+// condition, selected with -DBENCH_UNTIL_<name>, and bench_compile once.
+
+#include "core.h"
+#include "programs.h"
+
+#ifndef BENCH_TILL
+#define BENCH_TILL 0x18
+#endif
+
+using bench_cpu = cpu6502;
+
+constexpr auto run() -> bench_cpu {
+  bench_cpu cpu;
+  load_fib(cpu, BENCH_TILL);
+
+#if defined(BENCH_UNTIL_NAME)
+  // The HLT check exec_until_hlt() used to do, for comparison.
+  while (bench_cpu::metadata[cpu.read(cpu.PC)].name != "HLT") {
+    cpu.exec();
+  }
+#elif defined(BENCH_UNTIL_PC)
+  cpu.exec_until<bench_cpu::until_pc<fib_hlt>>();
+#else
+  cpu.exec_until<bench_cpu::until_hlt>();
+#endif
+
+  return cpu;
+}
+
+constexpr auto result = run();
+static_assert(result.PC == fib_hlt);
+
+auto main() -> int { return result.A; }
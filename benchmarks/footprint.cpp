@@ -0,0 +1,44 @@
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "bench.h"
+#include "core.h"
+
+// Per-instance size and copy cost of cpu6502, and the size of a result kept
+// by run_constexpr() instead.
+
+auto main() -> int {
+  constexpr std::size_t instances = 4096;
+  constexpr std::size_t iterations = 100000;
+
+  report_bytes("sizeof(cpu6502)", sizeof(cpu6502));
+  report_bytes("4096 instances", instances * sizeof(cpu6502));
+
+  using result = std::tuple<registers, memory_range<0x1200, 32>>;
+  report_bytes("registers + 32 B from run_constexpr", sizeof(result));
+
+  auto source = std::make_unique<cpu6502>();
+  source->load_program({0xa9, 0x01, 0x69, 0x01, 0x02});
+  source->exec_until_hlt();
+
+  auto target = std::make_unique<cpu6502>();
+
+  report("copy", measure(iterations, [&] {
+           *target = *source;
+           do_not_optimize(*target);
+         }));
+
+  report("construct", measure(iterations, [&] {
+           auto cpu = std::make_unique<cpu6502>();
+           do_not_optimize(*cpu);
+         }));
+
+  std::vector<cpu6502> bank(instances);
+  report("copy bank, per instance", measure(10, [&] {
+           std::vector<cpu6502> copy = bank;
+           do_not_optimize(copy.back());
+         }) / instances);
+
+  return 0;
+}
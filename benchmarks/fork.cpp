@@ -0,0 +1,56 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// Forking a warmed up cpu 100k times: a flat_memory copy against a
+// paged_memory one, which shares its RAM frames until they are written.
+
+namespace {
+
+constexpr std::size_t forks = 100'000;
+
+// Instructions each fork runs, about 12 fib iterations: enough to write to
+// the output and the zero page.
+constexpr int steps = 400;
+
+template <typename Cpu>
+auto fork(const char* name) -> void {
+  auto parent = std::make_unique<Cpu>();
+  load_fib(*parent);
+  parent->exec_n(100'000);
+
+  fmt::print("{}\n", name);
+
+  report("  fork", measure(forks, [&] {
+    auto child = std::make_unique<Cpu>(*parent);
+    do_not_optimize(*child);
+  }));
+
+  std::size_t owned = 0;
+  report("  fork, run 400 instructions", measure(forks, [&] {
+    auto child = std::make_unique<Cpu>(*parent);
+    child->exec_n(steps);
+    do_not_optimize(*child);
+
+    if constexpr (std::is_same_v<Cpu, bus_cpu6502>) {
+      owned = child->memory.owned_frames() * paged_memory::frame_size;
+    }
+  }));
+
+  report_bytes("  bytes per fork", sizeof(Cpu) + owned);
+}
+
+}  // namespace
+
+auto main() -> int {
+  fork<cpu6502>("flat_memory");
+  fork<bus_cpu6502>("paged_memory");
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include <fmt/base.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "bench.h"
+#include "core.h"
+#include "jit.h"
+#include "programs.h"
+
+// Interpreter throughput on the fib workload, per execution core.
+
+namespace {
+
+constexpr std::size_t runs = 20;
+
+auto fib_instructions() -> std::uint64_t {
+  auto cpu = std::make_unique<cpu6502>();
+  load_fib(*cpu);
+
+  std::uint64_t instructions = 0;
+  while (cpu->read(cpu->PC) != hlt) {
+    cpu->exec_table();
+    instructions++;
+  }
+
+  return instructions;
+}
+
+// `run` executes fib on a freshly loaded cpu up to its HLT.
+template <typename Run>
+auto mips(const char* name, std::uint64_t instructions, Run&& run) -> void {
+  auto ns = measure(runs, [&] {
+    auto cpu = std::make_unique<cpu6502>();
+    load_fib(*cpu);
+    run(*cpu);
+    do_not_optimize(*cpu);
+  });
+
+  fmt::print("{:<40} {:>14.2f} MIPS\n", name,
+             static_cast<double>(instructions) / ns * 1000);
+}
+
+}  // namespace
+
+auto main() -> int {
+  auto instructions = fib_instructions();
+
+  mips("exec_table", instructions, [](cpu6502& cpu) {
+    while (cpu.read(cpu.PC) != hlt) {
+      cpu.exec_table();
+    }
+  });
+
+  mips("exec_switch", instructions, [](cpu6502& cpu) {
+    while (cpu.read(cpu.PC) != hlt) {
+      cpu.exec_switch();
+    }
+  });
+
+  auto cache = std::make_unique<decode_cache>();
+  mips("exec_cached", instructions, [&](cpu6502& cpu) {
+    cpu.attach(cache.get());
+    while (cpu.read(cpu.PC) != hlt) {
+      cpu.exec_cached();
+    }
+  });
+
+  fmt::print("{:<40} {:>14} hits {} misses {} invalidations\n", "decode_cache",
+             cache->hits, cache->misses, cache->invalidations);
+
+  std::uint64_t built = 0;
+  std::uint64_t chained = 0;
+  mips("block_engine", instructions, [&](cpu6502& cpu) {
+    block_engine engine(cpu);
+    engine.exec_until_hlt();
+    built += engine.blocks_built;
+    chained += engine.chained;
+  });
+
+  fmt::print("{:<40} {:>14} built {} chained\n", "block_engine", built,
+             chained);
+
+  std::uint64_t compiled = 0;
+  std::uint64_t native = 0;
+  mips("jit_engine", instructions, [&](cpu6502& cpu) {
+    jit_engine engine(cpu);
+    engine.exec_until_hlt();
+    compiled += engine.blocks_compiled;
+    native += engine.native_instructions;
+  });
+
+  fmt::print("{:<40} {:>14} compiled {} native instructions\n", "jit_engine",
+             compiled, native);
+
+  return 0;
+}
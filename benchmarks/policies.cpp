@@ -0,0 +1,89 @@
+#include <fmt/base.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// Interpreter throughput on fib for every combination of memory, check,
+// trace and timing policy.
+
+namespace {
+
+constexpr std::size_t runs = 10;
+
+template <typename T>
+constexpr auto policy_name() -> const char* {
+  if constexpr (std::is_same_v<T, flat_memory>) {
+    return "flat";
+  } else if constexpr (std::is_same_v<T, unchecked>) {
+    return "unchecked";
+  } else if constexpr (std::is_same_v<T, checked>) {
+    return "checked";
+  } else if constexpr (std::is_same_v<T, no_trace>) {
+    return "no_trace";
+  } else if constexpr (std::is_same_v<T, cycle_timing>) {
+    return "cycles";
+  } else if constexpr (std::is_same_v<T, no_timing>) {
+    return "no_timing";
+  } else if constexpr (std::is_same_v<T, ring_trace<64>>) {
+    return "ring_trace";
+  } else {
+    return "undo_trace";
+  }
+}
+
+template <typename Memory, typename Check, typename Trace, typename Timing>
+auto mips() -> void {
+  using cpu_type = basic_cpu6502<Memory, Check, Trace, Timing>;
+
+  std::uint64_t instructions = 0;
+  auto ns = measure(runs, [&] {
+    auto cpu = std::make_unique<cpu_type>();
+    load_fib(*cpu);
+
+    instructions = 0;
+    while (cpu->read(cpu->PC) != hlt) {
+      cpu->exec();
+      instructions++;
+    }
+
+    do_not_optimize(*cpu);
+  });
+
+  auto name = std::string(policy_name<Memory>()) + " " + policy_name<Check>() +
+              " " + policy_name<Trace>() + " " + policy_name<Timing>();
+  fmt::print("{:<40} {:>14.2f} MIPS\n", name,
+             static_cast<double>(instructions) / ns * 1000);
+}
+
+template <typename Memory, typename Check, typename Trace>
+auto timings() -> void {
+  mips<Memory, Check, Trace, cycle_timing>();
+  mips<Memory, Check, Trace, no_timing>();
+}
+
+template <typename Memory, typename Check>
+auto traces() -> void {
+  timings<Memory, Check, no_trace>();
+  timings<Memory, Check, ring_trace<64>>();
+  timings<Memory, Check, undo_trace<4096>>();
+}
+
+template <typename Memory>
+auto checks() -> void {
+  traces<Memory, unchecked>();
+  traces<Memory, checked>();
+}
+
+}  // namespace
+
+auto main() -> int {
+  checks<flat_memory>();
+
+  return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef CONSTEXPR_6502_BENCHMARKS_PROGRAMS_H
+#define CONSTEXPR_6502_BENCHMARKS_PROGRAMS_H
+
+#include "core.h"
+
+// Address of the CMP operand holding the last page fib writes to.
+constexpr word fib_till = 0x1061;
+
+// Address of the final HLT.
+constexpr word fib_hlt = 0x1067;
+
+// examples/fib.a65, assembled with scripts/asm2arr.py. Fills 0x1200-0xfeff
+// with 16 bit Fibonacci numbers and stops on HLT. A smaller `till` stops
+// once the output pointer reaches page `till` instead.
+template <typename Cpu>
+constexpr auto load_fib(Cpu& cpu, byte till = 0xff) -> void {
+  cpu.load_program(
+      {0xa9, 0x00, 0x8d, 0x00, 0x12, 0x8d, 0x01, 0x12, 0xe8, 0xa9,
+       0x01, 0x8d, 0x02, 0x12, 0xa9, 0x00, 0x8d, 0x03, 0x12, 0xa9,
+       0x00, 0x85, 0x02, 0x85, 0x03, 0xa9, 0x01, 0x85, 0x04, 0xa9,
+       0x00, 0x85, 0x05, 0xa9, 0x04, 0x85, 0x00, 0xa9, 0x12, 0x85,
+       0x01, 0x18, 0xa5, 0x02, 0x65, 0x04, 0x85, 0x06, 0xa5, 0x03,
+       0x65, 0x05, 0x85, 0x07, 0xa0, 0x00, 0xa5, 0x06, 0x91, 0x00,
+       0xc8, 0xa5, 0x07, 0x91, 0x00, 0xa5, 0x04, 0x85, 0x02, 0xa5,
+       0x05, 0x85, 0x03, 0xa5, 0x06, 0x85, 0x04, 0xa5, 0x07, 0x85,
+       0x05, 0x18, 0xa5, 0x00, 0x69, 0x02, 0x85, 0x00, 0xa5, 0x01,
+       0x69, 0x00, 0x85, 0x01, 0xa5, 0x01, 0xc9, 0xff, 0xb0, 0x03,
+       0x4c, 0x29, 0x10, 0x02});
+  cpu.write(fib_till, till);
+}
+
+constexpr byte hlt = cpu6502::hlt_opcode;
+
+#endif
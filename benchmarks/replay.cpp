@@ -0,0 +1,96 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "bench.h"
+#include "core.h"
+
+// A loop storing what it reads from a device, with an interrupt every 1000
+// cycles: run against the device, recorded, replayed from the log, and
+// with the last 64 instructions traced, next to what keeping the whole
+// trace would take.
+
+namespace {
+
+constexpr int steps = 1'000'000;
+constexpr std::uint64_t interval = 1000;
+
+class counter : public bus_device {
+ public:
+  auto read(word /*addr*/) -> byte override { return m_count++; }
+  auto write(word /*addr*/, byte /*data*/) -> void override {}
+
+ private:
+  byte m_count = 0;
+};
+
+// loop: LDA $c000; STA $2000,X; INX; JMP loop, with an interrupt handler
+// at $3000: INC $10; RTI.
+template <typename Cpu>
+auto load(Cpu& cpu) -> void {
+  cpu.load_program({0xad, 0x00, 0xc0, 0x9d, 0x00, 0x20, 0xe8, 0x4c, 0x00,
+                    0x10});
+  cpu.load_program({0xe6, 0x10, 0x40}, 0x3000);
+  cpu.write16(0xfffe, 0x3000);
+  cpu.SP = 0xff;
+}
+
+template <typename Cpu, typename Interrupt>
+auto run(Cpu& cpu, Interrupt&& interrupt) -> void {
+  auto next = interval;
+  for (int i = 0; i < steps; i++) {
+    if (cpu.cycles >= next) {
+      interrupt(cpu);
+      next += interval;
+    }
+    cpu.exec();
+  }
+}
+
+auto per_instruction(double ns) -> double { return ns / steps; }
+
+}  // namespace
+
+auto main() -> int {
+  counter device;
+
+  auto live = std::make_unique<bus_cpu6502>();
+  load(*live);
+  live->memory.map_device(0xc0, 1, device);
+  report("live device, ns per instruction", per_instruction(measure(1, [&] {
+           run(*live, [](auto& cpu) { cpu.irq(); });
+         })));
+
+  auto recorded = std::make_unique<bus_cpu6502>();
+  load(*recorded);
+  input_recorder recorder(recorded->cycles);
+  recorded->memory.map_device(0xc0, 1, recorder.wrap(device));
+  report("recorded, ns per instruction", per_instruction(measure(1, [&] {
+           run(*recorded, [&](auto& cpu) { recorder.irq(cpu); });
+         })));
+  report_bytes("  log size", recorder.log.bytes.size());
+
+  auto replayed = std::make_unique<bus_cpu6502>();
+  load(*replayed);
+  input_replayer replayer(recorder.log, replayed->cycles);
+  replayed->memory.map_device(0xc0, 1, replayer);
+  report("replayed, ns per instruction", per_instruction(measure(1, [&] {
+           replayer.exec_n(*replayed, steps);
+         })));
+  do_not_optimize(*replayed);
+
+  using traced_cpu =
+      basic_cpu6502<paged_memory, unchecked, ring_trace<64>, cycle_timing>;
+  auto traced = std::make_unique<traced_cpu>();
+  load(*traced);
+  traced->memory.map_device(0xc0, 1, device);
+  report("traced, ns per instruction", per_instruction(measure(1, [&] {
+           run(*traced, [](auto& cpu) { cpu.irq(); });
+         })));
+  do_not_optimize(*traced);
+  report_bytes("  a full trace, kept", sizeof(trace_entry) * steps);
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <fmt/base.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// Resetting a cpu to a baseline after a short run, for every memory model:
+// flat copies 64K, tracked_memory copies the pages written since and
+// paged_memory shares the baseline's frames.
+
+namespace {
+
+constexpr std::size_t resets = 100'000;
+
+// Instructions run between resets, about 3 fib iterations.
+constexpr int steps = 100;
+
+template <typename Cpu>
+auto reset(const char* name) -> void {
+  auto cpu = std::make_unique<Cpu>();
+  load_fib(*cpu);
+  cpu->exec_n(100'000);
+
+  if constexpr (std::is_same_v<Cpu, tracked_cpu6502>) {
+    cpu->memory.clean();
+  }
+
+  auto baseline = std::make_unique<Cpu>(*cpu);
+
+  fmt::print("{}\n", name);
+
+  double restore_ns = 0;
+  auto total_ns = measure(resets, [&] {
+    cpu->exec_n(steps);
+    do_not_optimize(*cpu);
+
+    auto begin = std::chrono::steady_clock::now();
+    cpu->restore(*baseline);
+    do_not_optimize(*cpu);
+    auto end = std::chrono::steady_clock::now();
+
+    restore_ns += std::chrono::duration<double, std::nano>(end - begin).count();
+  });
+
+  report("  run 100 instructions, restore", total_ns);
+  report("  restore", restore_ns / resets);
+
+  if constexpr (std::is_same_v<Cpu, tracked_cpu6502>) {
+    cpu->exec_n(steps);
+    std::size_t dirty = 0;
+    for (std::size_t page = 0; page < 0x100; page++) {
+      dirty += cpu->memory.is_dirty(page) ? 1 : 0;
+    }
+    report_bytes("  dirty after 100 instructions", dirty * 0x100);
+  }
+}
+
+}  // namespace
+
+auto main() -> int {
+  reset<cpu6502>("flat_memory");
+  reset<tracked_cpu6502>("tracked_memory");
+  reset<bus_cpu6502>("paged_memory");
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// Many cpus running the same firmware: each with its own copy in flat
+// memory, against one rom_image mapped into every paged_memory.
+
+namespace {
+
+constexpr std::size_t instances = 1024;
+constexpr std::size_t rounds = 20;
+
+// Instructions each cpu runs per round, before moving on to the next cpu.
+constexpr int slice = 200;
+
+// fib, at 0x1000, stopping once it has filled 0x1200-0x1fff.
+constexpr byte till = 0x20;
+
+auto firmware() -> rom_image {
+  auto cpu = std::make_unique<cpu6502>();
+  load_fib(*cpu, till);
+
+  return rom_image(&cpu->memory.bytes[0x1000], paged_memory::page_size);
+}
+
+template <typename Cpu, typename Load>
+auto run(const char* name, Load&& load) -> void {
+  std::vector<std::unique_ptr<Cpu>> cpus;
+  for (std::size_t i = 0; i < instances; i++) {
+    cpus.push_back(std::make_unique<Cpu>());
+    load(*cpus.back());
+    cpus.back()->PC = 0x1000;
+  }
+
+  fmt::print("{}\n", name);
+
+  auto ns = measure(rounds, [&] {
+    for (auto& cpu : cpus) {
+      cpu->exec_n(slice);
+    }
+  });
+  report("  200 instructions, round robin", ns / instances);
+
+  std::size_t bytes = instances * sizeof(Cpu);
+  if constexpr (std::is_same_v<Cpu, bus_cpu6502>) {
+    for (auto& cpu : cpus) {
+      bytes += cpu->memory.owned_frames() * paged_memory::frame_size;
+    }
+  }
+  report_bytes("  bytes per cpu", bytes / instances);
+}
+
+}  // namespace
+
+auto main() -> int {
+  run<cpu6502>("flat_memory, private copy",
+               [](auto& cpu) { load_fib(cpu, till); });
+
+  auto image = firmware();
+  run<bus_cpu6502>("paged_memory, shared rom_image",
+                   [&](auto& cpu) { cpu.memory.map_rom(0x10, image); });
+
+  return 0;
+}
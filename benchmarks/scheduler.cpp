@@ -0,0 +1,94 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// What a resume costs the scheduler, with tasks that do nothing, then four
+// cpus on fib and a timer interleaved by a scheduler against a hand
+// written round robin loop, for several quanta.
+
+namespace {
+
+constexpr std::size_t cpus = 4;
+constexpr std::uint64_t span = 10'000'000;  // cycles of board time
+constexpr std::uint64_t timer_period = 1000;
+
+auto make_cpus() -> std::vector<std::unique_ptr<cpu6502>> {
+  std::vector<std::unique_ptr<cpu6502>> made;
+  for (std::size_t i = 0; i < cpus; i++) {
+    made.push_back(std::make_unique<cpu6502>());
+    load_fib(*made.back());
+  }
+  return made;
+}
+
+auto empty_tasks() -> void {
+  constexpr std::uint64_t resumes = 10'000'000;
+
+  scheduler board;
+  for (std::size_t i = 0; i < cpus + 1; i++) {
+    board.add([](std::uint64_t now) { return now + 1; });
+  }
+
+  auto ns = measure(1, [&] { board.run_until(resumes / (cpus + 1)); });
+  report("empty tasks, per resume", ns / static_cast<double>(board.resumes));
+}
+
+auto run(std::uint64_t quantum) -> void {
+  std::uint64_t ticks = 0;
+
+  auto by_hand = make_cpus();
+  auto manual_ns = measure(1, [&] {
+    std::uint64_t next_tick = timer_period;
+    for (std::uint64_t now = 0; now < span; now += quantum) {
+      for (auto& cpu : by_hand) {
+        cpu->exec_cycles(quantum);
+      }
+      for (; next_tick <= now; next_tick += timer_period) {
+        ticks++;
+      }
+    }
+    do_not_optimize(by_hand);
+  });
+
+  auto scheduled = make_cpus();
+  std::vector<std::unique_ptr<cpu_task<cpu6502>>> tasks;
+  scheduler board;
+  for (auto& cpu : scheduled) {
+    tasks.push_back(std::make_unique<cpu_task<cpu6502>>(*cpu, quantum));
+    board.add(*tasks.back());
+  }
+  board.add(
+      [&](std::uint64_t now) {
+        ticks++;
+        return now + timer_period;
+      },
+      timer_period);
+
+  auto scheduled_ns = measure(1, [&] {
+    board.run_until(span);
+    do_not_optimize(scheduled);
+  });
+
+  fmt::print("quantum {:>4} cycles {:>7.1f} ms by hand {:>7.1f} ms scheduled, "
+             "{} resumes\n",
+             quantum, manual_ns / 1e6, scheduled_ns / 1e6, board.resumes);
+  do_not_optimize(ticks);
+}
+
+}  // namespace
+
+auto main() -> int {
+  empty_tasks();
+  for (std::uint64_t quantum : {10, 100, 1000}) {
+    run(quantum);
+  }
+
+  return 0;
+}
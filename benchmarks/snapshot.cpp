@@ -0,0 +1,59 @@
+#include <fmt/base.h>
+
+#include <cstddef>
+#include <memory>
+#include <sstream>
+
+#include "bench.h"
+#include "core.h"
+#include "programs.h"
+
+// save_state() and load_state() of a cpu through fib, with most pages still
+// zero, and of one whose 64K are all in use.
+
+namespace {
+
+constexpr std::size_t runs = 10'000;
+
+auto run(const char* name, const cpu6502& cpu) -> void {
+  auto target = std::make_unique<cpu6502>();
+  auto saved = save_state(cpu);
+
+  fmt::print("{}\n", name);
+  report_bytes("  snapshot size", saved.size());
+
+  report("  save_state() to a buffer", measure(runs, [&] {
+           auto bytes = save_state(cpu);
+           do_not_optimize(bytes);
+         }));
+  report("  load_state() from a buffer", measure(runs, [&] {
+           load_state(*target, saved.data(), saved.size());
+           do_not_optimize(*target);
+         }));
+
+  std::stringstream stream;
+  report("  save_state() and load_state(), stream", measure(runs, [&] {
+           stream.str({});
+           stream.clear();
+           save_state(cpu, stream);
+           load_state(*target, stream);
+           do_not_optimize(*target);
+         }));
+}
+
+}  // namespace
+
+auto main() -> int {
+  auto fib = std::make_unique<cpu6502>();
+  load_fib(*fib, 0x40);
+  fib->exec_until_hlt();
+  run("fib up to 0x4000", *fib);
+
+  auto full = std::make_unique<cpu6502>();
+  for (std::size_t addr = 0; addr < 0x10000; addr++) {
+    full->memory.bytes[addr] = static_cast<byte>(addr * 7 + 1);
+  }
+  run("all 64K in use", *full);
+
+  return 0;
+}
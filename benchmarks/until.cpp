@@ -0,0 +1,79 @@
+#include <fmt/base.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "bench.h"
+#include "compile.h"
+#include "core.h"
+#include "programs.h"
+
+// Cost of the exec_until() stop conditions: at run time on the full fib
+// program, and in the constant evaluator by compiling constexpr.cpp once
+// per condition.
+
+namespace {
+
+constexpr std::size_t runs = 20;
+
+auto fib_instructions() -> std::uint64_t {
+  auto cpu = std::make_unique<cpu6502>();
+  load_fib(*cpu);
+
+  std::uint64_t instructions = 0;
+  while (cpu->read(cpu->PC) != hlt) {
+    cpu->exec();
+    instructions++;
+  }
+
+  return instructions;
+}
+
+// `run` executes fib on a freshly loaded cpu up to its HLT.
+template <typename Run>
+auto mips(const char* name, std::uint64_t instructions, Run&& run) -> void {
+  auto ns = measure(runs, [&] {
+    auto cpu = std::make_unique<cpu6502>();
+    load_fib(*cpu);
+    run(*cpu);
+    do_not_optimize(*cpu);
+  });
+
+  fmt::print("{:<40} {:>14.2f} MIPS\n", name,
+             static_cast<double>(instructions) / ns * 1000);
+}
+
+}  // namespace
+
+auto main() -> int {
+  auto instructions = fib_instructions();
+
+  mips("HLT by name", instructions, [](cpu6502& cpu) {
+    while (cpu6502::metadata[cpu.read(cpu.PC)].name != "HLT") {
+      cpu.exec();
+    }
+  });
+
+  mips("until_hlt", instructions,
+       [](cpu6502& cpu) { cpu.exec_until<cpu6502::until_hlt>(); });
+
+  mips("until_pc", instructions,
+       [](cpu6502& cpu) { cpu.exec_until<cpu6502::until_pc<fib_hlt>>(); });
+
+  mips("exec_n", instructions,
+       [&](cpu6502& cpu) { cpu.exec_n(static_cast<int>(instructions)); });
+
+  auto constexpr_run = [](const char* name, const char* define) {
+    auto flags = raised_limits;
+    if (define != nullptr) {
+      flags.emplace_back(define);
+    }
+    report_compile(name, compile("benchmarks/constexpr.cpp", flags));
+  };
+
+  constexpr_run("constexpr HLT by name", "-DBENCH_UNTIL_NAME");
+  constexpr_run("constexpr until_hlt", nullptr);
+  constexpr_run("constexpr until_pc", "-DBENCH_UNTIL_PC");
+
+  return 0;
+}
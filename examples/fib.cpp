@@ -1,23 +1,36 @@
+#include <array>
 #include <chrono>
 #include <iostream>
+#include <tuple>
 #include "core.h"
 
-// #define constexpr
-#include "cpu.h"
+// Last page written to, overridable to time the constant evaluator on
+// longer runs (see bench_compile).
+#ifndef FIB_TILL
+#define FIB_TILL 0x1f
+#endif
+
+constexpr uint8_t till = FIB_TILL;
+
+constexpr std::array<byte, 104> program = [] {
+  std::array<byte, 104> program = {0xa9, 0x00, 0x8d, 0x00, 0x12, 0x8d, 0x01, 0x12, 0xe8, 0xa9, 0x01, 0x8d, 0x02, 0x12, 0xa9, 0x00, 0x8d, 0x03, 0x12, 0xa9, 0x00, 0x85, 0x02, 0x85, 0x03, 0xa9, 0x01, 0x85, 0x04, 0xa9, 0x00, 0x85, 0x05, 0xa9, 0x04, 0x85, 0x00, 0xa9, 0x12, 0x85, 0x01, 0x18, 0xa5, 0x02, 0x65, 0x04, 0x85, 0x06, 0xa5, 0x03, 0x65, 0x05, 0x85, 0x07, 0xa0, 0x00, 0xa5, 0x06, 0x91, 0x00, 0xc8, 0xa5, 0x07, 0x91, 0x00, 0xa5, 0x04, 0x85, 0x02, 0xa5, 0x05, 0x85, 0x03, 0xa5, 0x06, 0x85, 0x04, 0xa5, 0x07, 0x85, 0x05, 0x18, 0xa5, 0x00, 0x69, 0x02, 0x85, 0x00, 0xa5, 0x01, 0x69, 0x00, 0x85, 0x01, 0xa5, 0x01, 0xc9, 0xff, 0xb0, 0x03, 0x4c, 0x29, 0x10, 0x02};
+  program[0x61] = till;  // operand of CMP #$ff
+  return program;
+}();
 
 int main() {
   std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
-  constexpr uint8_t till = 0x1f;
-  constexpr cpu6502 cpu = [till] {
-    cpu6502 cpu;
-    cpu.load_program({0xa9, 0x00, 0x8d, 0x00, 0x12, 0x8d, 0x01, 0x12, 0xe8, 0xa9, 0x01, 0x8d, 0x02, 0x12, 0xa9, 0x00, 0x8d, 0x03, 0x12, 0xa9, 0x00, 0x85, 0x02, 0x85, 0x03, 0xa9, 0x01, 0x85, 0x04, 0xa9, 0x00, 0x85, 0x05, 0xa9, 0x04, 0x85, 0x00, 0xa9, 0x12, 0x85, 0x01, 0x18, 0xa5, 0x02, 0x65, 0x04, 0x85, 0x06, 0xa5, 0x03, 0x65, 0x05, 0x85, 0x07, 0xa0, 0x00, 0xa5, 0x06, 0x91, 0x00, 0xc8, 0xa5, 0x07, 0x91, 0x00, 0xa5, 0x04, 0x85, 0x02, 0xa5, 0x05, 0x85, 0x03, 0xa5, 0x06, 0x85, 0x04, 0xa5, 0x07, 0x85, 0x05, 0x18, 0xa5, 0x00, 0x69, 0x02, 0x85, 0x00, 0xa5, 0x01, 0x69, 0x00, 0x85, 0x01, 0xa5, 0x01, 0xc9, 0xff, 0xb0, 0x03, 0x4c, 0x29, 0x10, 0x02});
-    cpu.exec_until_hlt();
-    return cpu;
-  }();
-  volatile cpu6502 another = cpu;
+  // Only the first 8 numbers end up in the binary, not the whole cpu.
+  constexpr auto result = run_constexpr<program, 0x1000, memory_range<0x1200, 16>>();
+  constexpr auto fib = std::get<0>(result);
 
   std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 
+  for (std::size_t i = 0; i < 8; i++) {
+    std::cout << fib.read16(i * 2) << " ";
+  }
+  std::cout << std::endl;
+
   std::cout << "Time difference = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "[µs]" << std::endl;
 }
@@ -0,0 +1,667 @@
+#ifndef CONSTEXPR_6502_BANK_H
+#define CONSTEXPR_6502_BANK_H
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "common.h"
+#include "cpu.h"
+#include "lanes.h"
+#include "opcodes.h"
+
+// How cpu6502_bank runs an opcode on all lanes at once: which operation,
+// how the operand is addressed, and the instruction's length and base
+// cycles. `what` is scalar for opcodes left to cpu6502::exec().
+struct lockstep_op {
+  enum class kind : byte {
+    scalar,
+    LDA, LDX, LDY, STA, STX, STY,
+    ADC, SBC, AND, ORA, EOR, CMP, CPX, CPY,
+    TAX, TAY, TXA, TYA, INX, INY, DEX, DEY,
+    ASL, LSR, ROL, ROR, CLC, SEC, NOP, JMP,
+    BNE, BEQ, BCC, BCS, BMI, BPL, BVC, BVS,
+  };
+
+  enum class mode : byte { other, IMP, IMM, ZP0, ZPX, ZPY, REL, ABS, ABX, ABY };
+
+  kind what = kind::scalar;
+  mode how = mode::other;
+  byte length = 1;
+  byte cycles = 0;
+
+  template <cpu6502::handler addrmode>
+  static constexpr auto mode_of() -> mode {
+    using _ = cpu6502;
+
+    if constexpr (addrmode == &_::IMP) {
+      return mode::IMP;
+    } else if constexpr (addrmode == &_::IMM) {
+      return mode::IMM;
+    } else if constexpr (addrmode == &_::ZP0) {
+      return mode::ZP0;
+    } else if constexpr (addrmode == &_::ZPX) {
+      return mode::ZPX;
+    } else if constexpr (addrmode == &_::ZPY) {
+      return mode::ZPY;
+    } else if constexpr (addrmode == &_::REL) {
+      return mode::REL;
+    } else if constexpr (addrmode == &_::ABS) {
+      return mode::ABS;
+    } else if constexpr (addrmode == &_::ABX) {
+      return mode::ABX;
+    } else if constexpr (addrmode == &_::ABY) {
+      return mode::ABY;
+    } else {
+      return mode::other;
+    }
+  }
+
+  // Read-modify-write ops only run in lockstep on A, and jumps only to an
+  // absolute address.
+  static constexpr auto classify(std::string_view name, mode how) -> kind {
+    constexpr std::array<std::pair<std::string_view, kind>, 38> kinds = {{
+        {"LDA", kind::LDA}, {"LDX", kind::LDX}, {"LDY", kind::LDY},
+        {"STA", kind::STA}, {"STX", kind::STX}, {"STY", kind::STY},
+        {"ADC", kind::ADC}, {"SBC", kind::SBC}, {"AND", kind::AND},
+        {"ORA", kind::ORA}, {"EOR", kind::EOR}, {"CMP", kind::CMP},
+        {"CPX", kind::CPX}, {"CPY", kind::CPY}, {"TAX", kind::TAX},
+        {"TAY", kind::TAY}, {"TXA", kind::TXA}, {"TYA", kind::TYA},
+        {"INX", kind::INX}, {"INY", kind::INY}, {"DEX", kind::DEX},
+        {"DEY", kind::DEY}, {"ASL", kind::ASL}, {"LSR", kind::LSR},
+        {"ROL", kind::ROL}, {"ROR", kind::ROR}, {"CLC", kind::CLC},
+        {"SEC", kind::SEC}, {"NOP", kind::NOP}, {"JMP", kind::JMP},
+        {"BNE", kind::BNE}, {"BEQ", kind::BEQ}, {"BCC", kind::BCC},
+        {"BCS", kind::BCS}, {"BMI", kind::BMI}, {"BPL", kind::BPL},
+        {"BVC", kind::BVC}, {"BVS", kind::BVS},
+    }};
+
+    if (how == mode::other) {
+      return kind::scalar;
+    }
+
+    for (auto [known, what] : kinds) {
+      if (known != name) {
+        continue;
+      }
+
+      auto shift = what == kind::ASL || what == kind::LSR ||
+                   what == kind::ROL || what == kind::ROR;
+      if ((shift && how != mode::IMP) ||
+          (what == kind::JMP && how != mode::ABS)) {
+        return kind::scalar;
+      }
+      return what;
+    }
+
+    return kind::scalar;
+  }
+};
+
+#define CONSTEXPR_6502_LOCKSTEP(code, name, operate, addrmode, base_cycles) \
+  lockstep_op{                                                              \
+      lockstep_op::classify(                                                \
+          name, lockstep_op::mode_of<&cpu6502::addrmode>()),                \
+      lockstep_op::mode_of<&cpu6502::addrmode>(), cpu6502::length(code),    \
+      base_cycles},
+
+inline constexpr std::array<lockstep_op, 0x100> lockstep_ops = {
+    {CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_LOCKSTEP)}};
+
+#undef CONSTEXPR_6502_LOCKSTEP
+
+// N cpu6502s running the same code on different data. Registers and flags
+// are kept as arrays with one lane per cpu; memory stays in each lane's own
+// cpu6502.
+//
+// While every lane is at the same PC on the same instruction bytes, and the
+// instruction is one of the common loads, stores, ALU ops, transfers and
+// branches, exec() runs it on all lanes at once with the byte vector
+// kernels of lanes.h, 32 lanes an AVX2 instruction or 16 an SSE2 one.
+// Memory is read and written one lane at a time, as each lane has its own.
+// Anything else runs per lane on cpu6502::exec().
+//
+// Lanes that diverge at a branch are stepped lowest PC first, and only those
+// at the lowest PC, until their PCs meet again: that is the end of an if
+// that some lanes skipped, or the exit of a loop some lanes ran for longer.
+// A lane parked on HLT waits for the others. The order lanes run in makes
+// no difference to their results, lanes share nothing, but a lane looping
+// forever at a low address keeps those above it waiting.
+//
+// The bank is large, N copies of a cpu6502: allocate it on the heap.
+template <std::size_t N>
+class cpu6502_bank {
+  static_assert(N > 0, "A bank needs lanes...");
+
+ public:
+  static constexpr std::size_t lanes = N;
+
+  template <typename T>
+  using lane_array = std::array<T, N>;
+
+  cpu6502_bank() : m_cpus(std::make_unique<std::array<cpu6502, N>>()) {
+    gather();
+  }
+
+  // The cpu6502 of a lane, with this bank's registers for it. Changes to it,
+  // registers and memory, are taken back by the next exec(); until then,
+  // further calls return it as it is, so edit the lane through it rather
+  // than through the bank's arrays.
+  auto lane(std::size_t index) -> cpu6502& {
+    if (!m_handed_out[index]) {
+      scatter(index);
+      m_handed_out.set(index);
+      forget_code();
+    }
+    return (*m_cpus)[index];
+  }
+
+  // Runs the next instruction on every lane, or while lanes are diverged,
+  // on those at the lowest PC.
+  auto exec() -> void {
+    take_back();
+
+    if (converged()) {
+      if (lockstep()) {
+        lockstep_steps++;
+      } else {
+        each([&](std::size_t i) { step(i); });
+        scalar_steps++;
+      }
+      return;
+    }
+
+    // The lowest PC among the lanes not parked on HLT, if there are any.
+    auto lowest = std::numeric_limits<std::size_t>::max();
+    each([&](std::size_t i) {
+      if (!halted(i)) {
+        lowest = std::min<std::size_t>(lowest, PC[i]);
+      }
+    });
+
+    each([&](std::size_t i) {
+      if (PC[i] == lowest || lowest > 0xffff) {
+        step(i);
+      }
+    });
+    scalar_steps++;
+  }
+
+  auto exec_n(int value = 1) -> void {
+    for (int i = 0; i < value; i++) {
+      exec();
+    }
+  }
+
+  // Runs until the next instruction of every lane is HLT, and steps over
+  // it, like cpu6502::exec_until_hlt().
+  auto exec_until_hlt() -> void {
+    take_back();
+
+    auto done = [&] {
+      bool all = true;
+      each([&](std::size_t i) { all = all && halted(i); });
+      return all;
+    };
+
+    while (!done()) {
+      exec();
+    }
+    each([&](std::size_t i) { PC[i]++; });
+  }
+
+  lane_array<byte> A{};
+  lane_array<byte> X{};
+  lane_array<byte> Y{};
+  lane_array<byte> SP{};
+  lane_array<word> PC{};
+  lane_array<byte> P{};
+
+  // What cpu6502's lazy N, V and Z flags are derived from, see flag.h, and
+  // C as 0 or 1.
+  lane_array<byte> n_input{};
+  lane_array<byte> v_input{};
+  lane_array<byte> z_input{};
+  lane_array<byte> carry{};
+
+  lane_array<std::uint64_t> cycles{};
+
+  // Steps run on all lanes at once, and lane by lane.
+  std::uint64_t lockstep_steps = 0;
+  std::uint64_t scalar_steps = 0;
+
+ private:
+  using kind = lockstep_op::kind;
+  using mode = lockstep_op::mode;
+  using op = lockstep_op;
+
+  template <typename F>
+  static auto each(F&& func) -> void {
+    for (std::size_t i = 0; i < N; i++) {
+      func(i);
+    }
+  }
+
+  auto memory(std::size_t index) -> std::array<byte, 0x10000>& {
+    return (*m_cpus)[index].memory.bytes;
+  }
+
+  auto halted(std::size_t index) -> bool {
+    return memory(index)[PC[index]] == cpu6502::hlt_opcode;
+  }
+
+  auto step(std::size_t index) -> void {
+    forget_code();
+    scatter(index);
+    (*m_cpus)[index].exec();
+    gather(index);
+  }
+
+  auto converged() const -> bool {
+    word diverged = 0;
+    each([&](std::size_t i) { diverged |= PC[i] ^ PC[0]; });
+    return diverged == 0;
+  }
+
+  // Whether every lane has the same `length` bytes at `pc` as lane 0. The
+  // answer is kept until a lane may have changed them: through lane(), a
+  // step lane by lane, or a lockstep store to a page with checked code.
+  auto same_code(word pc, byte length) -> bool {
+    auto& checked = m_checked[pc & 0xff];
+    auto key = m_generation << 16 | pc;
+    if (checked == key) {
+      return true;
+    }
+
+    const auto& code = memory(0);
+    for (word offset = 0; offset < length; offset++) {
+      auto addr = static_cast<word>(pc + offset);
+      for (std::size_t i = 1; i < N; i++) {
+        if (memory(i)[addr] != code[addr]) {
+          return false;
+        }
+      }
+    }
+
+    checked = key;
+    m_code_pages.set(pc >> 8);
+    m_code_pages.set(static_cast<word>(pc + length - 1) >> 8);
+    return true;
+  }
+
+  auto forget_code() -> void {
+    m_generation++;
+    m_code_pages.reset();
+  }
+
+  // Runs the next instruction on all lanes, if they all agree on its bytes
+  // and it is one of the kinds above. Returns false, having changed
+  // nothing, otherwise.
+  auto lockstep() -> bool {
+    auto pc = PC[0];
+    const auto& code = memory(0);
+    const auto& next = lockstep_ops[code[pc]];
+
+    if (next.what == kind::scalar) {
+      return false;
+    }
+
+    if (!same_code(pc, next.length)) {
+      return false;
+    }
+
+    auto after = static_cast<word>(pc + next.length);
+    word arg = 0x0000;
+    if (next.length == 3) {
+      arg = static_cast<word>(code[static_cast<word>(pc + 2)] << 8 |
+                              code[static_cast<word>(pc + 1)]);
+    } else if (next.length == 2) {
+      arg = code[static_cast<word>(pc + 1)];
+    }
+
+    PC.fill(after);
+    each([&](std::size_t i) { cycles[i] += next.cycles; });
+
+    run(next, arg);
+    return true;
+  }
+
+  // Effective address of the operand on each lane, and the extra cycle of
+  // the reads that cross a page.
+  auto addresses(mode how, word arg, lane_array<word>& address,
+                 bool penalty) -> void {
+    auto indexed = [&](const lane_array<byte>& reg, word wrap) {
+      each([&](std::size_t i) {
+        address[i] = static_cast<word>((arg + reg[i]) & wrap);
+      });
+    };
+
+    switch (how) {
+      case mode::ZP0:
+        address.fill(arg & 0x00ff);
+        return;
+      case mode::ZPX:
+        return indexed(X, 0x00ff);
+      case mode::ZPY:
+        return indexed(Y, 0x00ff);
+      case mode::ABX:
+      case mode::ABY:
+        indexed(how == mode::ABX ? X : Y, 0xffff);
+        if (penalty) {
+          each([&](std::size_t i) {
+            cycles[i] += static_cast<int>((address[i] & 0xff00) !=
+                                          (arg & 0xff00));
+          });
+        }
+        return;
+      default:
+        address.fill(arg);
+        return;
+    }
+  }
+
+  // The byte each lane reads: the immediate operand, or memory. Each lane
+  // has memory of its own, so reads from it are one lane at a time.
+  auto operands(mode how, word arg, lane_array<byte>& fetched) -> void {
+    if (how == mode::IMM) {
+      fetched.fill(static_cast<byte>(arg));
+      return;
+    }
+
+    lane_array<word> address;
+    addresses(how, arg, address, true);
+    each([&](std::size_t i) { fetched[i] = memory(i)[address[i]]; });
+  }
+
+  auto store(mode how, word arg, const lane_array<byte>& data) -> void {
+    lane_array<word> address;
+    addresses(how, arg, address, false);
+    each([&](std::size_t i) { (*m_cpus)[i].write(address[i], data[i]); });
+
+    bool code = false;
+    each([&](std::size_t i) { code = code || m_code_pages[address[i] >> 8]; });
+    if (code) {
+      forget_code();
+    }
+  }
+
+  // Takes the branch on the lanes where `taken` is set. Lockstep lanes are
+  // all at the same PC, so they all branch to the same target.
+  auto branch(word arg, const lane_array<byte>& taken) -> void {
+    auto from = PC[0];
+    auto target = static_cast<word>(from + to_signed(static_cast<byte>(arg)));
+    auto extra = 1 + static_cast<int>((target & 0xff00) != (from & 0xff00));
+
+    each([&](std::size_t i) {
+      PC[i] = taken[i] != 0 ? target : from;
+      cycles[i] += taken[i] != 0 ? extra : 0;
+    });
+  }
+
+  // The kernels below take a lane vector type V from lanes::each(), either
+  // lanes::wide or lanes::one, and the first lane it covers.
+  auto run(const op& next, word arg) -> void {
+    lane_array<byte> fetched;
+    lane_array<byte> taken;
+
+    // Sets Z and N from a result, like Z().from() and N().from().
+    auto result = [&](auto value, std::size_t i) {
+      value.store(&z_input[i]);
+      value.store(&n_input[i]);
+    };
+
+    auto load = [&](lane_array<byte>& reg) {
+      operands(next.how, arg, fetched);
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto value = V::load(&fetched[i]);
+        value.store(&reg[i]);
+        result(value, i);
+      });
+    };
+
+    auto compare = [&](const lane_array<byte>& reg) {
+      operands(next.how, arg, fetched);
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto value = V::load(&reg[i]);
+        auto operand = V::load(&fetched[i]);
+        (eq(max(value, operand), value) & V::splat(1)).store(&carry[i]);
+        result(value - operand, i);
+      });
+    };
+
+    auto transfer = [&](lane_array<byte>& to, const lane_array<byte>& from) {
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto value = V::load(&from[i]);
+        value.store(&to[i]);
+        result(value, i);
+      });
+    };
+
+    auto step = [&](lane_array<byte>& reg, byte delta) {
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto value = V::load(&reg[i]) + V::splat(delta);
+        value.store(&reg[i]);
+        result(value, i);
+      });
+    };
+
+    auto logic = [&](auto func) {
+      operands(next.how, arg, fetched);
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto value = func(V::load(&A[i]), V::load(&fetched[i]));
+        value.store(&A[i]);
+        result(value, i);
+      });
+    };
+
+    // Only the low bit of carry is kept, so it adds and shifts in as is.
+    auto add = [&](byte flip) {
+      operands(next.how, arg, fetched);
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto a = V::load(&A[i]);
+        auto operand = V::load(&fetched[i]) ^ V::splat(flip);
+        auto c = V::load(&carry[i]);
+        auto sum = a + operand;
+        auto value = sum + c;
+
+        // Either addition carried where the saturating one stopped short.
+        auto kept = eq(adds(a, operand), sum) & eq(adds(sum, c), value);
+        ((kept ^ V::splat(0xff)) & V::splat(1)).store(&carry[i]);
+        ((value ^ a) & (value ^ operand)).store(&v_input[i]);
+        value.store(&A[i]);
+        result(value, i);
+      });
+    };
+
+    auto shift_left = [&](byte rotate) {
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto a = V::load(&A[i]);
+        auto in = V::load(&carry[i]) & V::splat(rotate);
+        auto value = a + a + in;
+        (eq(max(a, V::splat(0x80)), a) & V::splat(1)).store(&carry[i]);
+        value.store(&A[i]);
+        result(value, i);
+      });
+    };
+
+    auto shift_right = [&](byte rotate) {
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto a = V::load(&A[i]);
+        auto in = V::splat(0) - (V::load(&carry[i]) & V::splat(rotate));
+        auto value = shr1(a) | (in & V::splat(0x80));
+        (a & V::splat(1)).store(&carry[i]);
+        value.store(&A[i]);
+        result(value, i);
+      });
+    };
+
+    // Branches where `flag & mask` is non zero, or zero when not `set`.
+    auto when = [&](const lane_array<byte>& flag, byte mask, bool set) {
+      lanes::each<N>([&](auto lane, std::size_t i) {
+        using V = decltype(lane);
+        auto clear = eq(V::load(&flag[i]) & V::splat(mask), V::splat(0));
+        (set ? clear ^ V::splat(0xff) : clear).store(&taken[i]);
+      });
+      branch(arg, taken);
+    };
+
+    switch (next.what) {
+      case kind::LDA:
+        return load(A);
+      case kind::LDX:
+        return load(X);
+      case kind::LDY:
+        return load(Y);
+      case kind::STA:
+        return store(next.how, arg, A);
+      case kind::STX:
+        return store(next.how, arg, X);
+      case kind::STY:
+        return store(next.how, arg, Y);
+      case kind::ADC:
+        return add(0x00);
+      case kind::SBC:
+        return add(0xff);
+      case kind::AND:
+        return logic([](auto a, auto b) { return a & b; });
+      case kind::ORA:
+        return logic([](auto a, auto b) { return a | b; });
+      case kind::EOR:
+        return logic([](auto a, auto b) { return a ^ b; });
+      case kind::CMP:
+        return compare(A);
+      case kind::CPX:
+        return compare(X);
+      case kind::CPY:
+        return compare(Y);
+      case kind::TAX:
+        return transfer(X, A);
+      case kind::TAY:
+        return transfer(Y, A);
+      case kind::TXA:
+        return transfer(A, X);
+      case kind::TYA:
+        return transfer(A, Y);
+      case kind::INX:
+        return step(X, 0x01);
+      case kind::INY:
+        return step(Y, 0x01);
+      case kind::DEX:
+        return step(X, 0xff);
+      case kind::DEY:
+        return step(Y, 0xff);
+      case kind::ASL:
+        return shift_left(0x00);
+      case kind::ROL:
+        return shift_left(0x01);
+      case kind::LSR:
+        return shift_right(0x00);
+      case kind::ROR:
+        return shift_right(0x01);
+      case kind::CLC:
+        carry.fill(0x00);
+        return;
+      case kind::SEC:
+        carry.fill(0x01);
+        return;
+      case kind::JMP:
+        PC.fill(arg);
+        return;
+      case kind::BNE:
+        return when(z_input, 0xff, true);
+      case kind::BEQ:
+        return when(z_input, 0xff, false);
+      case kind::BCC:
+        return when(carry, 0x01, false);
+      case kind::BCS:
+        return when(carry, 0x01, true);
+      case kind::BPL:
+        return when(n_input, 0x80, false);
+      case kind::BMI:
+        return when(n_input, 0x80, true);
+      case kind::BVC:
+        return when(v_input, 0x80, false);
+      case kind::BVS:
+        return when(v_input, 0x80, true);
+      case kind::NOP:
+      case kind::scalar:
+        return;
+    }
+  }
+
+  // Copies lane registers out to their cpu6502, and back.
+  auto scatter(std::size_t i) -> void {
+    auto& cpu = (*m_cpus)[i];
+    cpu.A = A[i];
+    cpu.X = X[i];
+    cpu.Y = Y[i];
+    cpu.SP = SP[i];
+    cpu.PC = PC[i];
+    cpu.P = P[i];
+    cpu.n_flag.from(n_input[i]);
+    cpu.v_flag.from(v_input[i]);
+    cpu.z_flag.from(z_input[i]);
+    cpu.c_flag.from(static_cast<word>(carry[i] << 8));
+    cpu.cycles = cycles[i];
+  }
+
+  auto gather(std::size_t i) -> void {
+    const auto& cpu = (*m_cpus)[i];
+    A[i] = cpu.A;
+    X[i] = cpu.X;
+    Y[i] = cpu.Y;
+    SP[i] = cpu.SP;
+    PC[i] = cpu.PC;
+    P[i] = cpu.P;
+    n_input[i] = cpu.n_flag.input();
+    v_input[i] = cpu.v_flag.input();
+    z_input[i] = cpu.z_flag.input();
+    carry[i] = cpu.c_flag ? 0x01 : 0x00;
+    cycles[i] = cpu.cycles;
+  }
+
+  auto gather() -> void {
+    for (std::size_t i = 0; i < N; i++) {
+      gather(i);
+    }
+  }
+
+  // Gathers the lanes handed out by lane().
+  auto take_back() -> void {
+    if (m_handed_out.none()) {
+      return;
+    }
+    each([&](std::size_t i) {
+      if (m_handed_out[i]) {
+        gather(i);
+      }
+    });
+    m_handed_out.reset();
+  }
+
+  std::unique_ptr<std::array<cpu6502, N>> m_cpus;
+  std::bitset<N> m_handed_out;
+
+  // Instructions known to be the same on every lane, by PC modulo 256, each
+  // as its PC and the generation it was checked in; and the pages they are
+  // on. A new generation forgets them all.
+  std::array<std::uint64_t, 0x100> m_checked{};
+  std::bitset<0x100> m_code_pages;
+  std::uint64_t m_generation = 1;
+};
+
+#endif
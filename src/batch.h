@@ -0,0 +1,116 @@
+#ifndef CONSTEXPR_6502_BATCH_H
+#define CONSTEXPR_6502_BATCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "cpu.h"
+#include "run.h"
+
+// A short, independent program for run_batch(). `program` is loaded at
+// `origin` into an otherwise zeroed memory, `initial` is applied, and the
+// cpu runs until the next instruction is HLT or at `stop`, or `budget`
+// instructions have run.
+struct batch_job {
+  const byte* program = nullptr;
+  std::size_t size = 0;
+  word origin = 0x1000;
+  registers initial{0x00, 0x00, 0x00, 0x00, 0x00, 0x1000, 0};
+  std::optional<word> stop;
+  std::uint64_t budget = UINT64_MAX;
+};
+
+struct batch_result {
+  // The registers when the job stopped, with PC on the HLT or at `stop`.
+  registers state;
+  std::uint64_t instructions;
+
+  // Whether the job stopped on HLT or at `stop` rather than on its budget.
+  bool halted;
+};
+
+// Runs `count` jobs on `threads` threads, the calling one included, and
+// writes the result of jobs[i] to results[i]. Each thread keeps one Cpu and
+// restores it to a blank copy between jobs, which for the default
+// tracked_cpu6502 only clears the pages the last job wrote.
+//
+// Threads take jobs in small chunks from a shared counter, so a thread
+// stuck on a long job leaves the rest to the others. The first exception a
+// job throws is rethrown once every thread has stopped; jobs that were not
+// run by then leave their results untouched.
+template <typename Cpu = tracked_cpu6502>
+auto run_batch(const batch_job* jobs, std::size_t count,
+               batch_result* results,
+               unsigned threads = std::thread::hardware_concurrency())
+    -> void {
+  constexpr std::size_t chunk = 16;
+
+  std::atomic<std::size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto run = [&](Cpu& cpu, const batch_job& job, batch_result& result) {
+    cpu.load(job.origin, job.program, job.size);
+    job.initial.apply(cpu);
+
+    std::uint64_t instructions = 0;
+    bool halted = false;
+    cpu.exec_until([&](const Cpu& current) {
+      halted = current.read(current.PC) == Cpu::hlt_opcode ||
+               current.PC == job.stop;
+      if (halted || instructions == job.budget) {
+        return true;
+      }
+      instructions++;
+      return false;
+    });
+
+    result = {registers::extract(cpu), instructions, halted};
+  };
+
+  auto worker = [&] {
+    try {
+      auto cpu = std::make_unique<Cpu>();
+      auto blank = std::make_unique<Cpu>(*cpu);
+
+      for (auto first = next.fetch_add(chunk); first < count;
+           first = next.fetch_add(chunk)) {
+        for (auto i = first; i < std::min(first + chunk, count); i++) {
+          run(*cpu, jobs[i], results[i]);
+          cpu->restore(*blank);
+        }
+      }
+    } catch (...) {
+      std::lock_guard lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      next = count;
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned i = 1; i < threads; i++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+
+  for (auto& thread : pool) {
+    thread.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+#endif
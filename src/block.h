@@ -0,0 +1,242 @@
+#ifndef CONSTEXPR_6502_BLOCK_H
+#define CONSTEXPR_6502_BLOCK_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "cache.h"
+#include "common.h"
+#include "cpu.h"
+
+// Runs a cpu6502 one basic block at a time. A block is a straight-line run
+// of predecoded instructions ending after a branch, JMP, JSR, RTS, RTI or
+// BRK, or just before a HLT. Each block remembers the blocks it exited to,
+// so hot paths chain from block to block without a lookup.
+//
+// The engine attaches its own decode_cache to the cpu and marks the pages it
+// decodes there. Any write to one of those pages drops every block, so
+// self-modifying code stays correct. Keeping data off code pages avoids
+// needless rebuilds.
+class block_engine {
+ public:
+  static constexpr std::size_t max_length = 32;
+
+  explicit block_engine(cpu6502& cpu) : m_cpu(&cpu) { m_cpu->attach(&m_cache); }
+
+  block_engine(const block_engine&) = delete;
+  block_engine(block_engine&&) = delete;
+  auto operator=(const block_engine&) -> block_engine& = delete;
+  auto operator=(block_engine&&) -> block_engine& = delete;
+
+  ~block_engine() { m_cpu->attach(nullptr); }
+
+  // Same semantics as cpu6502::exec_n().
+  auto exec_n(int value = 1) -> void {
+    while (value > 0 && !diverged()) {
+      value -= run(value);
+    }
+  }
+
+  // Same semantics as cpu6502::exec_until_hlt().
+  auto exec_until_hlt() -> void {
+    while (m_cpu->read(m_cpu->PC) != hlt && !diverged()) {
+      run(max_length);
+    }
+    m_cpu->PC++;
+
+    if (m_reference) {
+      m_reference->PC++;
+    }
+  }
+
+  // Mirrors every block on a plain interpreter and compares the two after
+  // each one. Execution stops at the first block whose result differs, with
+  // its PC in divergence().
+  auto lockstep(bool enable) -> void {
+    m_divergence.reset();
+
+    if (enable) {
+      m_reference = *m_cpu;
+    } else {
+      m_reference.reset();
+    }
+  }
+
+  [[nodiscard]] auto diverged() const -> bool {
+    return m_divergence.has_value();
+  }
+
+  [[nodiscard]] auto divergence() const -> std::optional<word> {
+    return m_divergence;
+  }
+
+  [[nodiscard]] auto reference() const -> const std::optional<cpu6502>& {
+    return m_reference;
+  }
+
+  auto flush() -> void {
+    for (const auto& cached : m_blocks) {
+      m_index[cached.pc] = none;
+    }
+    m_blocks.clear();
+    m_current = none;
+    m_cache.flush();
+    m_code_writes = m_cache.code_writes;
+  }
+
+  std::uint64_t blocks_built = 0;
+  std::uint64_t blocks_run = 0;
+  std::uint64_t chained = 0;
+  std::uint64_t flushes = 0;
+
+ private:
+  static constexpr byte hlt = cpu6502::hlt_opcode;
+  static constexpr std::int32_t none = -1;
+
+  struct link {
+    word pc = 0x0000;
+    std::int32_t target = none;
+  };
+
+  struct block {
+    word pc = 0x0000;
+    std::vector<decode_cache::entry> code;
+    std::array<link, 2> next{};
+  };
+
+  // Control flow instructions that end a block.
+  static constexpr auto ends_block(byte opcode) -> bool {
+    switch (opcode) {
+      case 0x00:  // BRK
+      case 0x10:  // BPL
+      case 0x20:  // JSR
+      case 0x30:  // BMI
+      case 0x40:  // RTI
+      case 0x4c:  // JMP abs
+      case 0x50:  // BVC
+      case 0x60:  // RTS
+      case 0x6c:  // JMP ind
+      case 0x70:  // BVS
+      case 0x90:  // BCC
+      case 0xb0:  // BCS
+      case 0xd0:  // BNE
+      case 0xf0:  // BEQ
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  auto build(word pc) -> std::int32_t {
+    block created;
+    created.pc = pc;
+
+    while (created.code.size() < max_length) {
+      // HLT only ever runs as a block of its own, so exec_until_hlt() can
+      // stop in front of it by checking PC between blocks.
+      auto opcode = m_cpu->read(pc);
+      if (opcode == hlt && !created.code.empty()) {
+        break;
+      }
+
+      decode_cache::entry decoded;
+      m_cpu->decode(pc, decoded);
+      m_cache.mark(pc, decoded.length);
+      created.code.push_back(decoded);
+      pc += decoded.length;
+
+      if (opcode == hlt || ends_block(opcode)) {
+        break;
+      }
+    }
+
+    blocks_built++;
+    m_blocks.push_back(std::move(created));
+
+    auto index = static_cast<std::int32_t>(m_blocks.size() - 1);
+    m_index[m_blocks.back().pc] = index;
+    return index;
+  }
+
+  // Block starting at PC, following the links of the block that ran last.
+  auto next_block() -> std::int32_t {
+    auto pc = m_cpu->PC;
+
+    if (m_current != none) {
+      for (auto& exit : m_blocks[m_current].next) {
+        if (exit.target != none && exit.pc == pc) {
+          chained++;
+          return exit.target;
+        }
+      }
+    }
+
+    auto target = m_index[pc];
+    if (target == none) {
+      target = build(pc);
+    }
+
+    if (m_current != none) {
+      auto& exits = m_blocks[m_current].next;
+      auto& slot = exits[0].target == none ? exits[0] : exits[1];
+      slot = {pc, target};
+    }
+
+    return target;
+  }
+
+  // Runs at most `budget` instructions of the block at PC and returns how
+  // many ran.
+  auto run(int budget) -> int {
+    if (m_cache.code_writes != m_code_writes) {
+      flushes++;
+      flush();
+    }
+
+    m_current = next_block();
+    const auto& code = m_blocks[m_current].code;
+    auto start = m_cpu->PC;
+
+    int count = 0;
+    for (const auto& decoded : code) {
+      if (count == budget) {
+        break;
+      }
+
+      m_cpu->exec_decoded(decoded);
+      count++;
+
+      if (m_cache.code_writes != m_code_writes) {
+        // The block may have overwritten itself, stop and rebuild.
+        m_current = none;
+        break;
+      }
+    }
+
+    blocks_run++;
+
+    if (m_reference) {
+      m_reference->exec_n(count);
+      if (!same_state(*m_cpu, *m_reference)) {
+        m_divergence = start;
+      }
+    }
+
+    return count;
+  }
+
+  cpu6502* m_cpu;
+  decode_cache m_cache;
+  std::uint64_t m_code_writes = 0;
+
+  std::vector<block> m_blocks;
+  std::vector<std::int32_t> m_index = std::vector<std::int32_t>(0x10000, none);
+  std::int32_t m_current = none;
+
+  std::optional<cpu6502> m_reference;
+  std::optional<word> m_divergence;
+};
+
+#endif
@@ -0,0 +1,292 @@
+#ifndef CONSTEXPR_6502_BUS_H
+#define CONSTEXPR_6502_BUS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+#include "cpu.h"
+
+// A device mapped into a paged_memory, like a UART or a timer. It sees the
+// full address of every access to its pages.
+class bus_device {
+ public:
+  bus_device() = default;
+  bus_device(const bus_device&) = delete;
+  bus_device(bus_device&&) = delete;
+  auto operator=(const bus_device&) -> bus_device& = delete;
+  auto operator=(bus_device&&) -> bus_device& = delete;
+  virtual ~bus_device() = default;
+
+  virtual auto read(word addr) -> byte = 0;
+  virtual auto write(word addr, byte data) -> void = 0;
+};
+
+// Throws on every access. Mapped as the write handler of ROM, it turns the
+// writes that would be ignored into errors.
+class write_trap : public bus_device {
+ public:
+  auto read(word /*addr*/) -> byte override {
+    throw std::runtime_error("write_trap: read");
+  }
+
+  auto write(word /*addr*/, byte /*data*/) -> void override {
+    throw std::runtime_error("write_trap: write to ROM");
+  }
+};
+
+// An immutable image, like a firmware, that many paged_memory instances
+// map as ROM. Copies share the bytes, and every memory it is mapped into
+// keeps them alive. The size is rounded up to whole pages with zeros.
+class rom_image {
+ public:
+  static constexpr std::size_t page_size = 0x100;
+
+  explicit rom_image(std::vector<byte> bytes)
+      : rom_image(owning(std::move(bytes))) {}
+
+  rom_image(const byte* data, std::size_t size)
+      : rom_image(std::vector<byte>(data, data + size)) {}
+
+  // Bytes kept alive by `data` itself, like those of a mapped file. They
+  // must be readable up to `size` rounded up to whole pages.
+  rom_image(std::shared_ptr<const byte> data, std::size_t size)
+      : m_data(std::move(data)),
+        m_size((size + page_size - 1) / page_size * page_size) {}
+
+  [[nodiscard]] auto data() const -> const byte* { return m_data.get(); }
+  [[nodiscard]] auto size() const -> std::size_t { return m_size; }
+  [[nodiscard]] auto pages() const -> std::size_t { return size() / page_size; }
+
+  // Number of rom_image copies, mapped or not, sharing these bytes.
+  [[nodiscard]] auto use_count() const -> long { return m_data.use_count(); }
+
+ private:
+  static auto owning(std::vector<byte> bytes) -> rom_image {
+    bytes.resize((bytes.size() + page_size - 1) / page_size * page_size);
+    auto owner = std::make_shared<const std::vector<byte>>(std::move(bytes));
+
+    return {std::shared_ptr<const byte>(owner, owner->data()), owner->size()};
+  }
+
+  std::shared_ptr<const byte> m_data;
+  std::size_t m_size;
+};
+
+// Memory model for basic_cpu6502 that routes every access through a table
+// of 256 pages of 256 bytes. A page is RAM, ROM (writes ignored) or a
+// device. RAM and ROM pages are reached through a pointer to their bytes,
+// one table load on top of a flat array access; only device pages take a
+// virtual call.
+//
+// RAM lives in 16 frames of 4 KB that copies share: copying a paged_memory
+// copies the tables and 16 references, and either side copies a frame on its
+// first write to it. RAM that was never written shares a single zero frame.
+// Copying also drops the source's write pointers, so one paged_memory must
+// not be copied from several threads at once.
+//
+// A rom_image is held by every paged_memory it is mapped into. External RAM,
+// raw ROM pointers and devices are not owned: they must outlive every
+// paged_memory they are mapped into, and copies share them. Run time only.
+class paged_memory {
+ public:
+  static constexpr std::size_t pages = 0x100;
+  static constexpr std::size_t page_size = 0x100;
+  static constexpr std::size_t frame_size = 0x1000;
+  static constexpr std::size_t frames = pages * page_size / frame_size;
+
+  // All RAM, zeroed.
+  paged_memory() {
+    m_frames.fill(std::make_shared<frame>());
+    map_ram(0x00, pages);
+  }
+
+  paged_memory(const paged_memory& other)
+      : m_frames(other.m_frames),
+        m_roms(other.m_roms),
+        m_read(other.m_read),
+        m_write(other.m_write),
+        m_device(other.m_device),
+        m_mapping(other.m_mapping) {
+    // Both sides now share every frame, and have to copy it before writing.
+    for (std::size_t page = 0; page < pages; page++) {
+      if (other.ram(page)) {
+        m_write[page] = other.m_write[page] = nullptr;
+      }
+    }
+  }
+
+  paged_memory(paged_memory&&) noexcept = default;
+
+  auto operator=(const paged_memory& other) -> paged_memory& {
+    if (this != &other) {
+      *this = paged_memory(other);
+    }
+    return *this;
+  }
+
+  auto operator=(paged_memory&&) noexcept -> paged_memory& = default;
+
+  ~paged_memory() = default;
+
+  [[nodiscard]] auto read(word addr) const -> byte {
+    const auto* data = m_read[addr >> 8];
+
+    if (data != nullptr) {
+      return data[addr & 0xff];
+    }
+
+    return m_device[addr >> 8]->read(addr);
+  }
+
+  auto write(word addr, byte value) -> void {
+    auto* data = m_write[addr >> 8];
+
+    if (data != nullptr) {
+      data[addr & 0xff] = value;
+    } else if (auto* device = m_device[addr >> 8]; device != nullptr) {
+      device->write(addr, value);
+    } else if (ram(addr >> 8)) {
+      own(addr >> 8);
+      m_write[addr >> 8][addr & 0xff] = value;
+    }
+  }
+
+  // Maps `count` pages from `first` back to this memory's own RAM, which
+  // keeps whatever was written there before.
+  auto map_ram(std::size_t first, std::size_t count) -> void {
+    for (auto page = first; page < first + count; page++) {
+      auto* data = ram_page(page);
+      auto owned = m_frames[page / pages_per_frame].use_count() == 1;
+      set(page, data, owned ? data : nullptr, nullptr);
+    }
+  }
+
+  // Maps `count` pages from `first` to `ram`, which holds at least
+  // count * page_size bytes and is shared rather than copied by copies.
+  auto map_ram(std::size_t first, std::size_t count, byte* ram) -> void {
+    for (std::size_t i = 0; i < count; i++) {
+      set(first + i, ram + i * page_size, ram + i * page_size, nullptr);
+    }
+  }
+
+  // Maps `count` pages from `first` to read `rom`, which holds at least
+  // count * page_size bytes. Writes to them go to `on_write`, or are ignored
+  // without one.
+  auto map_rom(std::size_t first, std::size_t count, const byte* rom,
+               bus_device* on_write = nullptr) -> void {
+    for (std::size_t i = 0; i < count; i++) {
+      set(first + i, rom + i * page_size, nullptr, on_write);
+    }
+  }
+
+  // Maps all of `image` from page `first`, and holds on to it.
+  auto map_rom(std::size_t first, const rom_image& image,
+               bus_device* on_write = nullptr) -> void {
+    map_rom(first, image.pages(), image.data(), on_write);
+
+    auto held = std::find_if(m_roms.begin(), m_roms.end(), [&](auto& rom) {
+      return rom.data() == image.data();
+    });
+    if (held == m_roms.end()) {
+      m_roms.push_back(image);
+    }
+  }
+
+  // Routes every access to `count` pages from `first` to `device`.
+  auto map_device(std::size_t first, std::size_t count, bus_device& device)
+      -> void {
+    for (auto page = first; page < first + count; page++) {
+      set(page, nullptr, nullptr, &device);
+    }
+  }
+
+  // Whether writes to `page` land, including RAM still shared with a copy.
+  [[nodiscard]] auto writable(std::size_t page) const -> bool {
+    return m_write[page] != nullptr || ram(page);
+  }
+
+  // Pages remapped so far. Decoded code from before a remap may be stale.
+  [[nodiscard]] auto mapping() const -> std::uint64_t { return m_mapping; }
+
+  [[nodiscard]] auto device(std::size_t page) const -> bus_device* {
+    return m_device[page];
+  }
+
+  // RAM frames no other paged_memory shares, the memory this one costs on
+  // top of its tables.
+  [[nodiscard]] auto owned_frames() const -> std::size_t {
+    std::size_t owned = 0;
+    for (const auto& storage : m_frames) {
+      owned += storage.use_count() == 1 ? 1 : 0;
+    }
+    return owned;
+  }
+
+ private:
+  static constexpr std::size_t pages_per_frame = frame_size / page_size;
+
+  using frame = std::array<byte, frame_size>;
+
+  auto set(std::size_t page, const byte* read, byte* write, bus_device* device)
+      -> void {
+    m_read[page] = read;
+    m_write[page] = write;
+    m_device[page] = device;
+    m_mapping++;
+  }
+
+  [[nodiscard]] auto ram_page(std::size_t page) const -> byte* {
+    return m_frames[page / pages_per_frame]->data() +
+           (page % pages_per_frame) * page_size;
+  }
+
+  [[nodiscard]] auto ram(std::size_t page) const -> bool {
+    return m_read[page] == ram_page(page);
+  }
+
+  // Makes the frame holding `page` this memory's own, copying it if it is
+  // shared, and lets the frame's RAM pages write again.
+  auto own(std::size_t page) -> void {
+    auto first = page / pages_per_frame * pages_per_frame;
+    auto& storage = m_frames[page / pages_per_frame];
+    const auto* shared = storage->data();
+
+    if (storage.use_count() != 1) {
+      storage = std::make_shared<frame>(*storage);
+    }
+
+    for (std::size_t i = 0; i < pages_per_frame; i++) {
+      if (m_read[first + i] == shared + i * page_size) {
+        m_read[first + i] = m_write[first + i] = ram_page(first + i);
+      }
+    }
+  }
+
+  std::array<std::shared_ptr<frame>, frames> m_frames;
+
+  // Every rom_image ever mapped, to keep it alive.
+  std::vector<rom_image> m_roms;
+
+  // Where each page reads and writes its bytes. Both are nullptr on device
+  // pages, and m_write is on ROM pages and on RAM in a shared frame. m_device
+  // takes the accesses they don't, which for ROM is only writes. Kept as
+  // separate arrays rather than one of structs: the hot path only loads the
+  // one it needs.
+  std::array<const byte*, pages> m_read{};
+  mutable std::array<byte*, pages> m_write{};
+  std::array<bus_device*, pages> m_device{};
+
+  std::uint64_t m_mapping = 0;
+};
+
+// A cpu6502 on a paged_memory.
+using bus_cpu6502 = basic_cpu6502<paged_memory>;
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef CONSTEXPR_6502_CACHE_H
+#define CONSTEXPR_6502_CACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+
+// Direct mapped cache of decoded instructions, keyed by PC. Attach one to a
+// cpu6502 with attach(); exec() then only decodes an instruction the first
+// time it runs. Writes through cpu6502::write() invalidate any cached
+// instruction they overlap, so self-modifying code stays correct.
+//
+// A cache belongs to a single cpu, of type Cpu. cpu.h defines decode_cache
+// for cpu6502.
+template <typename Cpu>
+class basic_decode_cache {
+ public:
+  static constexpr std::size_t size = 0x400;
+
+  struct entry {
+    void (Cpu::*execute)() = nullptr;
+    word pc = 0x0000;
+    word operand = 0x0000;
+    byte opcode = 0x00;
+    byte length = 0;
+    bool valid = false;
+  };
+
+  constexpr auto at(word pc) -> entry& { return entries[pc % size]; }
+
+  // Records that the bytes [pc, pc + length) hold a cached instruction.
+  constexpr auto mark(word pc, byte length) -> void {
+    set_page(pc >> 8);
+    set_page(static_cast<word>(pc + length - 1) >> 8);
+  }
+
+  // Drops every cached instruction that covers addr. Pages without cached
+  // code are rejected by a single bit test.
+  constexpr auto invalidate(word addr) -> void {
+    if (!is_code(addr >> 8)) {
+      return;
+    }
+
+    code_writes++;
+
+    for (word back = 0; back < 3; back++) {
+      auto pc = static_cast<word>(addr - back);
+      auto& cached = at(pc);
+
+      if (cached.valid && cached.pc == pc && back < cached.length) {
+        cached.valid = false;
+        invalidations++;
+      }
+    }
+  }
+
+  constexpr auto flush() -> void {
+    for (auto& cached : entries) {
+      cached.valid = false;
+    }
+    code = {};
+  }
+
+  // One bit per 256 byte page that holds cached code.
+  [[nodiscard]] constexpr auto code_pages() const
+      -> const std::array<std::uint64_t, 4>& {
+    return code;
+  }
+
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t invalidations = 0;
+
+  // Writes that landed on a marked page, whether or not they hit a cached
+  // entry. Users that keep decoded code elsewhere, like block_engine, mark
+  // their pages and watch this counter.
+  std::uint64_t code_writes = 0;
+
+  // The cpu memory's mapping() the entries were decoded under.
+  std::uint64_t mapping = 0;
+
+ private:
+  [[nodiscard]] constexpr auto is_code(std::size_t page) const -> bool {
+    return ((code[page / 64] >> (page % 64)) & 1) != 0;
+  }
+
+  constexpr auto set_page(std::size_t page) -> void {
+    code[page / 64] |= std::uint64_t{1} << (page % 64);
+  }
+
+  std::array<entry, size> entries{};
+
+  // One bit per 256 byte page that holds at least one cached instruction.
+  std::array<std::uint64_t, 4> code{};
+};
+
+#endif
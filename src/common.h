@@ -12,6 +12,16 @@ using sbyte = std::int8_t;
 
 using instructions = std::initializer_list<byte>;
 
+// std::is_constant_evaluated() is C++20. GCC and Clang provide the builtin
+// it is built on in C++17 as well; elsewhere this is always false.
+constexpr auto is_constant_evaluated() -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_is_constant_evaluated();
+#else
+  return false;
+#endif
+}
+
 template <typename T>
 constexpr auto to_signed(T value) -> std::make_signed_t<T> {
   using signed_t = std::make_signed_t<T>;
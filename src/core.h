@@ -1,8 +1,22 @@
 #ifndef CONSTEXPR_6502_CORE_H
 #define CONSTEXPR_6502_CORE_H
 
+#include "bank.h"
+#include "batch.h"
 #include "bit.h"
+#include "block.h"
+#include "bus.h"
+#include "cache.h"
 #include "common.h"
+#include "flag.h"
 #include "cpu.h"
+#include "mapper.h"
+#include "memory.h"
+#include "opcodes.h"
+#include "policy.h"
+#include "replay.h"
+#include "run.h"
+#include "scheduler.h"
+#include "snapshot.h"
 
 #endif
@@ -2,119 +2,578 @@
 #define CONSTEXPR_6502_CPU_H
 
 #include <array>
+#include <cstddef>
+#include <cstring>
 #include <functional>
+#include <stdexcept>
 #include <string_view>
+#include <type_traits>
+
+#include "bit.h"
+#include "cache.h"
+#include "common.h"
+#include "flag.h"
+#include "memory.h"
+#include "opcodes.h"
+#include "policy.h"
+
+// A 6502 over the memory model `Memory` (see memory.h), with the check,
+// trace and timing policies in policy.h. cpu6502 is the flat 64K one with
+// cycle counting and nothing else.
+template <typename Memory = flat_memory, typename Check = unchecked,
+          typename Trace = no_trace, typename Timing = cycle_timing>
+class basic_cpu6502 {
+ public:
+  using handler = void (basic_cpu6502::*)();
+  using decode_cache = basic_decode_cache<basic_cpu6502>;
 
-#include "core.h"
+  constexpr basic_cpu6502() = default;
+
+  // A decode cache is keyed by PC alone and belongs to one cpu, so a copy
+  // never shares it: a copy starts detached, and a cpu assigned to keeps
+  // its own cache, flushed as by restore().
+  constexpr basic_cpu6502(const basic_cpu6502& other)
+      : memory(other.memory), trace(other.trace) {
+    copy_registers(other);
+  }
+
+  constexpr auto operator=(const basic_cpu6502& other) -> basic_cpu6502& {
+    if (this != &other) {
+      copy_registers(other);
+      memory = other.memory;
+      trace = other.trace;
+      forget_code();
+    }
+    return *this;
+  }
 
-class cpu6502 {
- public:
-  constexpr cpu6502() = default;
   auto reset() -> void;
 
+  // Runs a single instruction on the core selected at compile time. Define
+  // CONSTEXPR_6502_SWITCH_CORE to use exec_switch(). With a decode cache
+  // attached, runs through exec_cached() instead.
+  //
+  // The constant evaluator always takes exec_switch(): it walks every call
+  // and member pointer it meets, and the switch core has the fewest of them
+  // per instruction.
   constexpr auto exec() -> void {
+    if (icache != nullptr) {
+      exec_cached();
+      return;
+    }
+
+    if (is_constant_evaluated()) {
+      exec_switch();
+      return;
+    }
+
+#ifdef CONSTEXPR_6502_SWITCH_CORE
+    exec_switch();
+#else
+    exec_table();
+#endif
+  }
+
+  // Dispatches through the fused handlers in lookup.
+  constexpr auto exec_table() -> void {
     auto opcode = fetch();
 
-    U = true;
+    if constexpr (Check::enabled || Trace::enabled) {
+      observe(PC - 1, opcode);
+    }
 
-    (this->*lookup.at(opcode).addrmode)();
-    (this->*lookup.at(opcode).operate)();
+    (this->*lookup[opcode])();
+  }
 
-    U = true;
+  // An addressing mode and an operation fused into one handler. Both calls
+  // are bound at compile time, so the compiler can inline them.
+  template <handler addrmode, handler operate, byte base_cycles>
+  constexpr void instruction() {
+    (this->*addrmode)();
+    (this->*operate)();
+    tick<addrmode, operate, base_cycles>();
   }
 
-  constexpr auto exec_n(int value = 1) -> void {
-    while (value-- > 0) {
+  // Reads through ABX, ABY and IZY take one more cycle when adding the index
+  // crosses a page. Stores and read-modify-write ops always take it, it is in
+  // their base count.
+  template <handler addrmode, handler operate>
+  static constexpr auto page_penalty() -> bool {
+    if constexpr (addrmode == &_::ABX || addrmode == &_::ABY ||
+                  addrmode == &_::IZY) {
+      return operate == &_::ADC || operate == &_::AND || operate == &_::CMP ||
+             operate == &_::EOR || operate == &_::LDA || operate == &_::LDX ||
+             operate == &_::LDY || operate == &_::ORA || operate == &_::SBC;
+    } else {
+      return false;
+    }
+  }
+
+  // Runs the check and trace policies on the instruction at `pc`, before it
+  // executes.
+  constexpr auto observe(word pc, byte opcode) -> void {
+    if constexpr (Check::enabled) {
+      Check::check(*this, pc, opcode);
+    }
+
+    if constexpr (Trace::enabled) {
+      trace.record(*this, pc, opcode);
+    }
+  }
+
+  // Counts the cycles of the instruction that just ran.
+  template <handler addrmode, handler operate, byte base_cycles>
+  constexpr void tick() {
+    if constexpr (!Timing::enabled) {
+      return;
+    }
+
+    cycles += base_cycles;
+
+    if constexpr (page_penalty<addrmode, operate>()) {
+      byte index = addrmode == &_::ABX ? X : Y;
+      auto base = static_cast<word>(address - index);
+      cycles += static_cast<int>((base & 0xff00) != (address & 0xff00));
+    }
+  }
+
+  // Dispatches through one switch over all opcodes, with the addressing mode
+  // and the operation of each case inlined together.
+  constexpr auto exec_switch() -> void {
+    auto opcode = fetch();
+
+    if constexpr (Check::enabled || Trace::enabled) {
+      observe(PC - 1, opcode);
+    }
+
+#define CONSTEXPR_6502_CASE(code, name, operate, addrmode, base_cycles) \
+  case code:                                                            \
+    decode<&_::addrmode>();                                             \
+    operate();                                                          \
+    tick<&_::addrmode, &_::operate, base_cycles>();                     \
+    break;
+
+    switch (opcode) { CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_CASE) }
+
+#undef CONSTEXPR_6502_CASE
+  }
+
+  // Runs the instruction at PC from the attached decode cache, decoding it
+  // on a miss. Remapping memory, such as a bank switch, drops all of it.
+  constexpr auto exec_cached() -> void {
+    if (icache->mapping != memory.mapping()) {
+      forget_code();
+    }
+
+    auto& cached = icache->at(PC);
+
+    if (cached.valid && cached.pc == PC) {
+      icache->hits++;
+    } else {
+      icache->misses++;
+      decode(PC, cached);
+      icache->mark(PC, cached.length);
+    }
+
+    exec_decoded(cached);
+  }
+
+  // Runs an instruction decoded by decode(). PC must be the address it was
+  // decoded from.
+  constexpr auto exec_decoded(const typename decode_cache::entry& decoded)
+      -> void {
+    if constexpr (Check::enabled || Trace::enabled) {
+      observe(PC, decoded.opcode);
+    }
+
+    opcode = decoded.opcode;
+    operand_word = decoded.operand;
+    PC += decoded.length;
+
+    (this->*decoded.execute)();
+  }
+
+  constexpr auto decode(word pc, typename decode_cache::entry& decoded) const
+      -> void {
+    decoded.opcode = read(pc);
+    decoded.length = length(decoded.opcode);
+    decoded.execute = predecoded[decoded.opcode];
+    decoded.pc = pc;
+    decoded.valid = true;
+
+    if (decoded.length == 3) {
+      decoded.operand = read16(pc + 1);
+    } else if (decoded.length == 2) {
+      decoded.operand = read(pc + 1);
+    } else {
+      decoded.operand = 0x0000;
+    }
+  }
+
+  // Handler for an instruction whose operand was extracted into
+  // operand_word, and PC advanced past it, by the decode cache.
+  template <handler addrmode, handler operate, byte base_cycles>
+  constexpr void predecoded_instruction() {
+    resolve<addrmode>(operand_word);
+    (this->*operate)();
+    tick<addrmode, operate, base_cycles>();
+  }
+
+  // Attaches a decode cache, or detaches with nullptr.
+  constexpr auto attach(decode_cache* cache) -> void {
+    icache = cache;
+
+    if (icache != nullptr) {
+      icache->flush();
+      icache->mapping = memory.mapping();
+    }
+  }
+
+  // Stop conditions for exec_until(), checked before every instruction.
+
+  // The next instruction is HLT.
+  struct until_hlt {
+    constexpr auto operator()(const basic_cpu6502& cpu) const -> bool {
+      return cpu.read(cpu.PC) == hlt_opcode;
+    }
+  };
+
+  // The next instruction is at `addr`.
+  template <word addr>
+  struct until_pc {
+    constexpr auto operator()(const basic_cpu6502& cpu) const -> bool {
+      return cpu.PC == addr;
+    }
+  };
+
+  // `remaining` instructions have run.
+  struct until_count {
+    int remaining;
+
+    constexpr auto operator()(const basic_cpu6502& /*cpu*/) -> bool {
+      return remaining-- <= 0;
+    }
+  };
+
+  // cpu.cycles has reached `end`.
+  struct until_cycles {
+    std::uint64_t end;
+
+    constexpr auto operator()(const basic_cpu6502& cpu) const -> bool {
+      return cpu.cycles >= end;
+    }
+  };
+
+  // Runs until `stop` returns true. The predicate is a template parameter,
+  // so it is inlined into the loop.
+  template <typename Predicate>
+  constexpr auto exec_until(Predicate stop = {}) -> void {
+    while (!stop(*this)) {
       exec();
     }
   }
 
+  constexpr auto exec_n(int value = 1) -> void {
+    exec_until(until_count{value});
+  }
+
+  // Runs until at least `budget` more cycles have passed. The last
+  // instruction may overshoot the budget.
+  constexpr auto exec_cycles(std::uint64_t budget) -> void {
+    static_assert(Timing::enabled, "Cycles are not counted...");
+    exec_until(until_cycles{cycles + budget});
+  }
+
   auto exec_all() -> void {
     while (true) {
       exec();
     }
   }
 
+  // Runs up to the next HLT and steps over it.
   constexpr auto exec_until_hlt() -> void {
-    // Execute until HLT is hit (0x20 opcode)
-    while (lookup[read(PC)].name != "HLT") {
-      exec();
-    }
+    exec_until<until_hlt>();
     PC++;
   }
 
-  constexpr auto load_program(instructions program) -> void {
-    word addr = 0x1000;
-    for (const auto &byte : program) {
-      write(addr++, byte);
+  // Undoes the last `count` instructions, with a trace policy that undoes
+  // like undo_trace. Returns how many it could undo.
+  constexpr auto step_back(std::size_t count = 1) -> std::size_t {
+    static_assert(Trace::undoes, "The trace keeps nothing to undo...");
+
+    auto undone = trace.undo(*this, count);
+    forget_code();
+    return undone;
+  }
+
+  // Interrupt request, between two instructions: pushes PC and the flags
+  // with B clear, sets I and jumps through $fffe, in 7 cycles. Ignored while
+  // I is set; returns whether it was taken.
+  constexpr auto irq() -> bool {
+    if (I()) {
+      return false;
+    }
+
+    interrupt(0xfffe);
+    return true;
+  }
+
+  // Non-maskable interrupt, as irq() but through $fffa and whatever I is.
+  constexpr auto nmi() -> void { interrupt(0xfffa); }
+
+  constexpr auto interrupt(word vector) -> void {
+    write(0x0100 + SP, (PC >> 8) & 0x00FF);
+    SP--;
+    write(0x0100 + SP, PC & 0x00FF);
+    SP--;
+    write(0x0100 + SP, static_cast<byte>(getFlag() & ~0b00010000));
+    SP--;
+
+    I() = true;
+    PC = read16(vector);
+
+    if constexpr (Timing::enabled) {
+      cycles += 7;
+    }
+  }
+
+  // Returns to the state of `baseline`, typically a copy of this cpu taken
+  // earlier. A tracked_memory only copies back its dirty pages, and
+  // paged_memory shares baseline's frames; other memories copy all of it.
+  // The decode cache stays attached but is flushed.
+  constexpr auto restore(const basic_cpu6502& baseline) -> void {
+    copy_registers(baseline);
+    trace = baseline.trace;
+
+    if constexpr (std::is_same_v<Memory, tracked_memory>) {
+      memory.restore(baseline.memory);
+    } else {
+      memory = baseline.memory;
+    }
+
+    forget_code();
+  }
+
+  constexpr auto load_program(instructions program, word origin = 0x1000)
+      -> void {
+    load(origin, program.begin(), program.size());
+  }
+
+  // Copies `size` bytes from `data` to memory at `origin`. flat_memory takes
+  // them in one copy, other models byte by byte through their write().
+  // Either way a load is not undone: it clears the history of a trace that
+  // undoes, so step_back() stops at it.
+  constexpr auto load(word origin, const byte* data, std::size_t size) -> void {
+    if (origin + size > 0x10000) {
+      throw std::length_error("load: past the end of memory");
+    }
+
+    if constexpr (std::is_same_v<Memory, flat_memory>) {
+      if (!is_constant_evaluated()) {
+        std::memcpy(&memory.bytes[origin], data, size);
+      } else {
+        for (std::size_t i = 0; i < size; i++) {
+          memory.bytes[origin + i] = data[i];
+        }
+      }
+    } else {
+      for (std::size_t i = 0; i < size; i++) {
+        memory.write(static_cast<word>(origin + i), data[i]);
+      }
+    }
+
+    if constexpr (Trace::undoes) {
+      trace.clear();
+    }
+
+    forget_code();
+  }
+
+  // Drops decoded code after memory changed without write(). Engines
+  // watching code_writes flush too.
+  constexpr auto forget_code() -> void {
+    if (icache != nullptr) {
+      icache->flush();
+      icache->mapping = memory.mapping();
+      icache->code_writes++;
     }
   }
 
   constexpr auto fetch() -> byte { return opcode = read(PC++); }
 
+  // flat_memory is indexed directly rather than through its read() and
+  // write(): the constant evaluator charges for every call, and these are
+  // the most frequent ones.
   [[nodiscard]] constexpr auto read(word addr) const -> byte {
-    return memory.at(addr);
+    if constexpr (std::is_same_v<Memory, flat_memory>) {
+      return memory.bytes[addr];
+    } else {
+      return memory.read(addr);
+    }
   }
 
   [[nodiscard]] constexpr auto read16(word addr) const -> word {
     return static_cast<word>(read(addr + 1) << 8 | read(addr));
   }
 
-  constexpr auto write(word addr, byte data) -> void { memory.at(addr) = data; }
+  constexpr auto write(word addr, byte data) -> void {
+    // Only RAM is put back by an undo: reading a device for its old byte
+    // could change it, and writing one back would mean nothing.
+    if constexpr (Trace::undoes) {
+      if (memory.writable(addr >> 8)) {
+        trace.wrote(addr, read(addr));
+      }
+    }
+
+    if constexpr (std::is_same_v<Memory, flat_memory>) {
+      memory.bytes[addr] = data;
+    } else {
+      memory.write(addr, data);
+    }
+
+    if (icache != nullptr) {
+      icache->invalidate(addr);
+    }
+  }
 
   constexpr auto write16(word addr, word data) -> void {
-    memory.at(addr) = static_cast<byte>(data);
-    memory.at(addr + 1) = static_cast<byte>(data >> 8);
+    write(addr, static_cast<byte>(data));
+    write(addr + 1, static_cast<byte>(data >> 8));
   }
 
   // ADDRESSING MODES
+  //
+  // Each mode reads its operand bytes at PC and passes them to
+  // resolve<mode>(), which computes the effective address. The decode cache
+  // calls resolve<mode>() directly on operands it extracted earlier.
+
+  constexpr void IMP() { decode<&_::IMP>(); }
+
+  constexpr void IMM() { decode<&_::IMM>(); }
+
+  constexpr void ZP0() { decode<&_::ZP0>(); }
+
+  constexpr void ZPX() { decode<&_::ZPX>(); }
 
-  constexpr void IMP() { operand = A; }
+  constexpr void ZPY() { decode<&_::ZPY>(); }
 
-  constexpr void IMM() { address = PC++; }
+  constexpr void REL() { decode<&_::REL>(); }
 
-  constexpr void ZP0() { address = fetch() & 0x00ff; }
+  constexpr void ABS() { decode<&_::ABS>(); }
 
-  constexpr void ZPX() { address = (fetch() + X) & 0x00ff; }
+  constexpr void ABX() { decode<&_::ABX>(); }
 
-  constexpr void ZPY() { address = (fetch() + Y) & 0x00ff; }
+  constexpr void ABY() { decode<&_::ABY>(); }
 
-  constexpr void REL() { address_rel = to_signed(fetch()); }
+  constexpr void IND() { decode<&_::IND>(); }
 
-  constexpr void ABS() {
-    address = read16(PC);
-    PC += 2;
+  constexpr void IZX() { decode<&_::IZX>(); }
+
+  constexpr void IZY() { decode<&_::IZY>(); }
+
+  // Instruction length in bytes, opcode included.
+  template <handler addrmode>
+  static constexpr auto length() -> byte {
+    if constexpr (addrmode == &_::IMP) {
+      return 1;
+    } else if constexpr (addrmode == &_::ABS || addrmode == &_::ABX ||
+                         addrmode == &_::ABY || addrmode == &_::IND) {
+      return 3;
+    } else {
+      return 2;
+    }
   }
 
-  constexpr void ABX() {
-    address = read16(PC) + X;
-    PC += 2;
+  static constexpr auto length(byte opcode) -> byte {
+#define CONSTEXPR_6502_LENGTH(code, name, operate, addrmode, base_cycles) \
+  case code:                                                              \
+    return length<&_::addrmode>();
+
+    switch (opcode) { CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_LENGTH) }
+
+#undef CONSTEXPR_6502_LENGTH
+
+    return 1;
   }
 
-  constexpr void ABY() {
-    address = read16(PC) + Y;
-    PC += 2;
+  template <handler addrmode>
+  constexpr void decode() {
+    word arg = 0x0000;
+
+    if constexpr (length<addrmode>() == 3) {
+      arg = read16(PC);
+    } else if constexpr (length<addrmode>() == 2) {
+      arg = read(PC);
+    }
+
+    PC += length<addrmode>() - 1;
+    resolve<addrmode>(arg);
   }
 
-  constexpr void IND() {
-    auto ptr = read16(PC);
-    PC += 2;
+  // Effective address of an operand, with PC already past the instruction.
+  template <handler addrmode>
+  constexpr void resolve(word arg) {
+    if constexpr (addrmode == &_::IMP) {
+      operand = A;
+    } else if constexpr (addrmode == &_::IMM) {
+      address = PC - 1;
+    } else if constexpr (addrmode == &_::ZP0) {
+      address = arg & 0x00ff;
+    } else if constexpr (addrmode == &_::ZPX) {
+      address = (arg + X) & 0x00ff;
+    } else if constexpr (addrmode == &_::ZPY) {
+      address = (arg + Y) & 0x00ff;
+    } else if constexpr (addrmode == &_::REL) {
+      address_rel = to_signed(static_cast<byte>(arg));
+    } else if constexpr (addrmode == &_::ABS) {
+      address = arg;
+    } else if constexpr (addrmode == &_::ABX) {
+      address = arg + X;
+    } else if constexpr (addrmode == &_::ABY) {
+      address = arg + Y;
+    } else if constexpr (addrmode == &_::IND) {
+      if ((arg & 0x00ff) == 0xff) {  // if ptr_lo == 0xff
+        address = (read(arg & 0xff00) << 8) | read(arg);
+      } else {  // expected behaviour
+        address = read16(arg);
+      }
+    } else if constexpr (addrmode == &_::IZX) {
+      auto ptr = arg + X;
+      address = (read((ptr + 1) & 0x00ff) << 8) | read(ptr & 0x00ff);
+    } else if constexpr (addrmode == &_::IZY) {
+      auto ptr = arg;
+      address = ((read((ptr + 1) & 0x00ff) << 8) | read(ptr & 0x00ff)) + Y;
+    }
+  }
 
-    if ((ptr & 0x00ff) == 0xff) {  // if ptr_lo == 0xff
-      address = (read(ptr & 0xff00) << 8) | read(ptr);
-    } else {  // expected behaviour
-      address = read16(ptr);
+  // Operand of a read-modify-write instruction: the accumulator for implied
+  // addressing, memory otherwise.
+  template <handler addrmode>
+  [[nodiscard]] constexpr auto load() const -> byte {
+    if constexpr (addrmode == &_::IMP) {
+      return A;
+    } else {
+      return read(address);
     }
   }
 
-  constexpr void IZX() {
-    auto ptr = fetch() + X;
-    address = (read((ptr + 1) & 0x00ff) << 8) | read(ptr & 0x00ff);
+  template <handler addrmode>
+  constexpr void store(byte data) {
+    if constexpr (addrmode == &_::IMP) {
+      A = data;
+    } else {
+      write(address, data);
+    }
   }
 
-  constexpr void IZY() {
-    auto ptr = fetch();
-    address = ((read((ptr + 1) & 0x00ff) << 8) | read(ptr & 0x00ff)) + Y;
+  // Takes a relative branch, one extra cycle and another one if the target
+  // is on a different page.
+  constexpr void branch() {
+    address = PC + address_rel;
+    if constexpr (Timing::enabled) {
+      cycles += 1 + static_cast<int>((address & 0xff00) != (PC & 0xff00));
+    }
+    PC = address;
   }
 
   // INSTRUCTIONS
@@ -122,12 +581,12 @@ class cpu6502 {
   // Add with Carry
   constexpr void ADC() {
     byte fetched = read(address);
-    word temp = A + fetched + static_cast<int>(C);
+    word temp = A + fetched + static_cast<int>(C());
 
-    C = temp > 255;
-    Z = (temp & 0x00FF) == 0;
-    V = ((~(A ^ fetched) & (A ^ temp)) & 0x0080) != 0;
-    N = (temp & 0x80) != 0;
+    C().from(temp);
+    Z().from(temp);
+    V().from(~(A ^ fetched) & (A ^ temp));
+    N().from(temp);
     A = (temp & 0x00FF);
   }
 
@@ -135,48 +594,41 @@ class cpu6502 {
   constexpr void AND() {
     byte fetched = read(address);
     A = A & fetched;
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   // Arithmetic Shift Left
+  template <handler addrmode>
   constexpr void ASL() {
-    byte fetched =
-        (lookup[opcode].addrmode == &cpu6502::IMP ? A : read(address));
+    byte fetched = load<addrmode>();
     word temp = (word)fetched << 1;
 
-    C = (temp & 0xFF00) > 0;
-    Z = (temp & 0x00FF) == 0x00;
-    N = (temp & 0x80) != 0;
+    C().from(temp);
+    Z().from(temp);
+    N().from(temp);
 
-    if (lookup.at(opcode).addrmode == &cpu6502::IMP) {
-      A = temp & 0x00FF;
-    } else {
-      write(address, temp & 0x00FF);
-    }
+    store<addrmode>(temp & 0x00FF);
   }
 
   // Branch if Carry Clear
   constexpr void BCC() {
-    if (!C) {
-      address = PC + address_rel;
-      PC = address;
+    if (!C()) {
+      branch();
     }
   }
 
   // Branch if Carry Set
   constexpr void BCS() {
-    if (C) {
-      address = PC + address_rel;
-      PC = address;
+    if (C()) {
+      branch();
     }
   }
 
   // Branch if Equal
   constexpr void BEQ() {
-    if (Z) {
-      address = PC + address_rel;
-      PC = address;
+    if (Z()) {
+      branch();
     }
   }
 
@@ -184,32 +636,29 @@ class cpu6502 {
   constexpr void BIT() {
     byte fetched = read(address);
     word temp = A & fetched;
-    Z = (temp & 0x00FF) == 0x00;
-    N = (fetched & (1 << 7)) != 0;
-    V = (fetched & (1 << 6)) != 0;
+    Z().from(temp);
+    N().from(fetched);
+    V().from(fetched << 1);
   }
 
   // Branch if Minus
   constexpr void BMI() {
-    if (N) {
-      address = PC + address_rel;
-      PC = address;
+    if (N()) {
+      branch();
     }
   }
 
   // Branch if Not Equal
   constexpr void BNE() {
-    if (!Z) {
-      address = PC + address_rel;
-      PC = address;
+    if (!Z()) {
+      branch();
     }
   }
 
   // Branch if Positive
   constexpr void BPL() {
-    if (!N) {
-      address = PC + address_rel;
-      PC = address;
+    if (!N()) {
+      branch();
     }
   }
 
@@ -217,113 +666,109 @@ class cpu6502 {
   constexpr void BRK() {
     PC++;
 
-    I = true;
+    I() = true;
     write(0x0100 + SP, (PC >> 8) & 0x00FF);
     SP--;
     write(0x0100 + SP, PC & 0x00FF);
     SP--;
 
-    B = true;
-    write(0x0100 + SP, getFlag());
+    write(0x0100 + SP, getFlag() | 0b00010000);
     SP--;
-    B = false;
 
     PC = read16(0xfffe);
   }
 
   // Branch if Overflow Clear
   constexpr void BVC() {
-    if (!V) {
-      address = PC + address_rel;
-      PC = address;
+    if (!V()) {
+      branch();
     }
   }
 
   // Branch if Overflow Set
   constexpr void BVS() {
-    if (V) {
-      address = PC + address_rel;
-      PC = address;
+    if (V()) {
+      branch();
     }
   }
 
-  constexpr void CLC() { C = false; }
+  constexpr void CLC() { C() = false; }
 
-  constexpr void CLD() { D = false; }
+  constexpr void CLD() { D() = false; }
 
-  constexpr void CLI() { I = false; }
+  constexpr void CLI() { I() = false; }
 
-  constexpr void CLV() { V = false; }
+  constexpr void CLV() { V() = false; }
 
   constexpr void CMP() {
     byte fetched = read(address);
     word temp = static_cast<word>(A) - static_cast<word>(fetched);
-    C = A >= fetched;
-    Z = (temp & 0x00FF) == 0x0000;
-    N = (temp & 0x0080) != 0;
+    C() = A >= fetched;
+    Z().from(temp);
+    N().from(temp);
   }
 
   constexpr void CPX() {
     byte fetched = read(address);
     word temp = static_cast<word>(X) - static_cast<word>(fetched);
-    C = X >= fetched;
-    Z = (temp & 0x00FF) == 0x0000;
-    N = (temp & 0x0080) != 0;
+    C() = X >= fetched;
+    Z().from(temp);
+    N().from(temp);
   }
 
   constexpr void CPY() {
     byte fetched = read(address);
     word temp = static_cast<word>(Y) - static_cast<word>(fetched);
-    C = Y >= fetched;
-    Z = (temp & 0x00FF) == 0x0000;
-    N = (temp & 0x0080) != 0;
+    C() = Y >= fetched;
+    Z().from(temp);
+    N().from(temp);
   }
 
   constexpr void DEC() {
     byte fetched = read(address);
     word temp = fetched - 1;
     write(address, temp & 0x00FF);
-    Z = (temp & 0x00FF) == 0x0000;
-    N = (temp & 0x0080) != 0;
+    Z().from(temp);
+    N().from(temp);
   }
 
   constexpr void DEX() {
     X--;
-    Z = X == 0x00;
-    N = (X & 0x80) != 0;
+    Z().from(X);
+    N().from(X);
   }
 
   constexpr void DEY() {
     Y--;
-    Z = Y == 0x00;
-    N = (Y & 0x80) != 0;
+    Z().from(Y);
+    N().from(Y);
   }
 
   constexpr void EOR() {
     byte fetched = read(address);
     A = A ^ fetched;
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   constexpr void INC() {
     byte fetched = read(address);
     word temp = fetched + 1;
     write(address, temp & 0x00FF);
-    Z = (temp & 0x00FF) == 0x0000;
-    N = (temp & 0x0080) != 0;
+    Z().from(temp);
+    N().from(temp);
   }
 
   constexpr void INX() {
     X++;
-    Z = X == 0x00;
-    N = (X & 0x80) != 0;
+    Z().from(X);
+    N().from(X);
   }
 
   constexpr void INY() {
     Y++;
-    Z = Y == 0x00;
-    N = (Y & 0x80) != 0;
+    Z().from(Y);
+    N().from(Y);
   }
 
   // Opcodes
@@ -339,44 +784,40 @@ class cpu6502 {
 
   constexpr void LDA() {
     A = read(address);
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   constexpr void LDX() {
     X = read(address);
-    Z = X == 0x00;
-    N = (X & 0x80) != 0;
+    Z().from(X);
+    N().from(X);
   }
 
   constexpr void LDY() {
     Y = read(address);
-    Z = Y == 0x00;
-    N = (Y & 0x80) != 0;
+    Z().from(Y);
+    N().from(Y);
   }
 
+  template <handler addrmode>
   constexpr void LSR() {
-    byte fetched = 
-      (lookup[opcode].addrmode == &cpu6502::IMP ? A : read(address));
+    byte fetched = load<addrmode>();
 
-    C = (fetched & 0x1) != 0;
+    C() = (fetched & 0x1) != 0;
     byte temp = fetched >> 1;
-    Z = temp == 0x00;
-    N = (temp & 0x80) != 0;
+    Z().from(temp);
+    N().from(temp);
 
-    if (lookup.at(opcode).addrmode == &cpu6502::IMP) {
-      A = temp;
-    } else {
-      write(address, temp);
-    }
+    store<addrmode>(temp);
   }
 
   constexpr void NOP() {}
 
   constexpr void ORA() {
     A = A | read(address);
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   constexpr void PHA() {
@@ -385,64 +826,51 @@ class cpu6502 {
   }
 
   constexpr void PHP() {
-    B = true;
-    U = true;
-
-    write(0x0100 + SP, getFlag());
+    // Pushed with B set, which is left clear.
+    write(0x0100 + SP, getFlag() | 0b00010000);
     SP--;
 
-    B = false;
-    U = false;
+    B() = false;
   }
 
   constexpr void PLA() {
     SP++;
     A = read(0x100 + SP);
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   constexpr void PLP() {
     SP++;
     setFlag(read(0x0100 + SP));
-    U = true;
   }
 
+  template <handler addrmode>
   constexpr void ROL() {
-    byte fetched = 
-      (lookup[opcode].addrmode == &cpu6502::IMP ? A : read(address));
-    word temp = (fetched << 1) | static_cast<word>(C);
-    C = (temp & 0xff00) != 0;
-    Z = (temp & 0xff) == 0x00;
-    N = (temp & 0x80) != 0;
-
-    if (lookup.at(opcode).addrmode == &cpu6502::IMP) {
-      A = temp & 0xff;
-    } else {
-      write(address, temp & 0xff);
-    }
+    byte fetched = load<addrmode>();
+    word temp = (fetched << 1) | static_cast<word>(C());
+    C().from(temp);
+    Z().from(temp);
+    N().from(temp);
+
+    store<addrmode>(temp & 0xff);
   }
 
+  template <handler addrmode>
   constexpr void ROR() {
-    byte fetched = 
-      (lookup[opcode].addrmode == &cpu6502::IMP ? A : read(address));
-    word temp = (static_cast<int>(C) << 7) | (fetched >> 1);
-    C = (fetched & 0x01) != 0;
-    Z = (temp & 0xff) == 0x00;
-    N = (temp & 0x80) != 0;
-
-    if (lookup.at(opcode).addrmode == &cpu6502::IMP) {
-      A = temp & 0xff;
-    } else {
-      write(address, temp & 0xff);
-    }
+    byte fetched = load<addrmode>();
+    word temp = (static_cast<int>(C()) << 7) | (fetched >> 1);
+    C() = (fetched & 0x01) != 0;
+    Z().from(temp);
+    N().from(temp);
+
+    store<addrmode>(temp & 0xff);
   }
 
   constexpr void RTI() {
     SP++;
     setFlag(read(0x0100 + SP));
-    B = false;
-    U = false;
+    B() = false;
 
     SP++;
     PC = read16(0x0100 + SP);
@@ -461,23 +889,23 @@ class cpu6502 {
     // We can invert the bottom 8 bits with bitwise xor
     byte fetched = read(address);
     word value = (fetched) ^ 0x00FF;
-    word temp = A + value + static_cast<int>(C);
+    word temp = A + value + static_cast<int>(C());
 
-    C = (temp & 0xFF00) != 0;
-    Z = ((temp & 0x00FF) == 0);
-    V = ((temp ^ A) & (temp ^ value) & 0x0080) != 0;
-    N = (temp & 0x0080) != 0;
+    C().from(temp);
+    Z().from(temp);
+    V().from((temp ^ A) & (temp ^ value));
+    N().from(temp);
     A = (temp & 0x00FF);
   }
 
   // Set Carry Flag
-  constexpr void SEC() { C = true; }
+  constexpr void SEC() { C() = true; }
 
   // Set Decimal Flag
-  constexpr void SED() { D = true; }
+  constexpr void SED() { D() = true; }
 
   // Set Interrupt Disable
-  constexpr void SEI() { I = true; }
+  constexpr void SEI() { I() = true; }
 
   // Store Accumulator
   constexpr void STA() { write(address, A); }
@@ -491,29 +919,29 @@ class cpu6502 {
   // Transfer Accumulator to X
   constexpr void TAX() {
     X = A;
-    Z = X == 0x00;
-    N = (X & 0x80) != 0;
+    Z().from(X);
+    N().from(X);
   }
 
   // Transfer Accumulator to Y
   constexpr void TAY() {
     Y = A;
-    Z = Y == 0x00;
-    N = (Y & 0x80) != 0;
+    Z().from(Y);
+    N().from(Y);
   }
 
   // Transfer Stack Pointer to X
   constexpr void TSX() {
     X = SP;
-    Z = X == 0x00;
-    N = (X & 0x80) != 0;
+    Z().from(X);
+    N().from(X);
   }
 
   // Transfer X to Accumulator
   constexpr void TXA() {
     A = X;
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   // Transfer X to Stack Pointer
@@ -522,8 +950,8 @@ class cpu6502 {
   // Transfer Y to Accumulator
   constexpr void TYA() {
     A = Y;
-    Z = A == 0x00;
-    N = (A & 0x80) != 0;
+    Z().from(A);
+    N().from(A);
   }
 
   // Extended Instruction Set
@@ -533,31 +961,60 @@ class cpu6502 {
   // Flag stuff
   // https://www.nesdev.org/wiki/Status_flags
   [[nodiscard]] constexpr auto getFlag() const -> byte {
-    auto n = static_cast<byte>(N);
-    auto v = static_cast<byte>(V);
-    auto u = static_cast<byte>(U);
-    auto b = static_cast<byte>(B);
-    auto d = static_cast<byte>(D);
-    auto i = static_cast<byte>(I);
-    auto z = static_cast<byte>(Z);
-    auto c = static_cast<byte>(C);
+    auto n = static_cast<byte>(N());
+    auto v = static_cast<byte>(V());
+    auto z = static_cast<byte>(Z());
+    auto c = static_cast<byte>(C());
 
-    return (n << 7) | (v << 6) | (u << 5) | (b << 4) | (d << 3) | (i << 2) |
-           (z << 1) | (c << 0);
+    return (P & packed_flags) | (n << 7) | (v << 6) | (z << 1) | (c << 0);
   }
 
   constexpr void setFlag(byte f) {
-    N = (f & 0b10000000) != 0;
-    V = (f & 0b01000000) != 0;
-    U = (f & 0b00100000) != 0;
-    B = (f & 0b10010000) != 0;
-    D = (f & 0b10001000) != 0;
-    I = (f & 0b10000100) != 0;
-    Z = (f & 0b10000010) != 0;
-    C = (f & 0b10000001) != 0;
+    P = (f & packed_flags) | unused_flag;
+    N().from(f);
+    V().from(f << 1);
+    Z() = (f & 0b00000010) != 0;
+    C() = (f & 0b00000001) != 0;
   }
 
+  // Status flags. D, I, B and U are bit views into P. N, V, Z and C keep
+  // the result they are derived from instead (see flag.h), getFlag() folds
+  // them into the byte pushed on the stack.
+  constexpr auto N() -> lazy_flag<byte, 0x80>& { return n_flag; }
+  constexpr auto V() -> lazy_flag<byte, 0x80>& { return v_flag; }
+  constexpr auto U() -> bit<byte, 5> { return bit<byte, 5>(P); }
+  constexpr auto B() -> bit<byte, 4> { return bit<byte, 4>(P); }
+  constexpr auto D() -> bit<byte, 3> { return bit<byte, 3>(P); }
+  constexpr auto I() -> bit<byte, 2> { return bit<byte, 2>(P); }
+  constexpr auto Z() -> lazy_flag<byte, 0xff, true>& { return z_flag; }
+  constexpr auto C() -> lazy_flag<word, 0x100>& { return c_flag; }
+
+  [[nodiscard]] constexpr auto N() const -> bool { return n_flag; }
+  [[nodiscard]] constexpr auto V() const -> bool { return v_flag; }
+  [[nodiscard]] constexpr auto U() const -> bool {
+    return bit<const byte, 5>(P).value();
+  }
+  [[nodiscard]] constexpr auto B() const -> bool {
+    return bit<const byte, 4>(P).value();
+  }
+  [[nodiscard]] constexpr auto D() const -> bool {
+    return bit<const byte, 3>(P).value();
+  }
+  [[nodiscard]] constexpr auto I() const -> bool {
+    return bit<const byte, 2>(P).value();
+  }
+  [[nodiscard]] constexpr auto Z() const -> bool { return z_flag; }
+  [[nodiscard]] constexpr auto C() const -> bool { return c_flag; }
+
+  // Bits of P that are stored there rather than evaluated lazily.
+  static constexpr byte packed_flags = 0b00111100;
+
+  // U reads as set on a real 6502. It is set from the start and nothing
+  // clears it, so instructions don't have to set it again.
+  static constexpr byte unused_flag = 0b00100000;
+
   byte operand = 0x00;
+  word operand_word = 0x0000;
   byte opcode = 0x00;
   word address = 0x0000;
   sbyte address_rel = 0x00;
@@ -569,45 +1026,109 @@ class cpu6502 {
   word PC = 0x1000;
   byte SP = 0x00;
 
-  bool N = false;
-  bool V = false;
-  bool U = false;
-  bool B = false;
-  bool D = false;
-  bool I = false;
-  bool Z = false;
-  bool C = false;
+  byte P = unused_flag;
+  lazy_flag<byte, 0x80> n_flag;
+  lazy_flag<byte, 0x80> v_flag;
+  lazy_flag<byte, 0xff, true> z_flag;
+  lazy_flag<word, 0x100> c_flag;
+
+  // Cycles run so far, see tick().
+  std::uint64_t cycles = 0;
+
+  Memory memory{};
+
+  decode_cache* icache = nullptr;
+
+  Trace trace{};
 
-  std::array<byte, 0x10000> memory{};
+  static constexpr byte hlt_opcode = 0x02;
 
+  // Cold part of the decode table, per opcode metadata.
   struct INSTRUCTION {
     std::string_view name;
-    void (cpu6502::*operate)() = nullptr;
-    void (cpu6502::*addrmode)() = nullptr;
+    byte cycles;
   };
 
-  using _ = cpu6502;
-
-  // clang-format off
-  std::array<INSTRUCTION, 0x100> lookup = {{
-		{ "BRK", &_::BRK, &_::IMM },{ "ORA", &_::ORA, &_::IZX },{ "HLT", &_::HLT, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ORA", &_::ORA, &_::ZP0 },{ "ASL", &_::ASL, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "PHP", &_::PHP, &_::IMP },{ "ORA", &_::ORA, &_::IMM },{ "ASL", &_::ASL, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ORA", &_::ORA, &_::ABS },{ "ASL", &_::ASL, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BPL", &_::BPL, &_::REL },{ "ORA", &_::ORA, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ORA", &_::ORA, &_::ZPX },{ "ASL", &_::ASL, &_::ZPX },{ "???", &_::NOP, &_::IMP },{ "CLC", &_::CLC, &_::IMP },{ "ORA", &_::ORA, &_::ABY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ORA", &_::ORA, &_::ABX },{ "ASL", &_::ASL, &_::ABX },{ "???", &_::NOP, &_::IMP },
-		{ "JSR", &_::JSR, &_::ABS },{ "AND", &_::AND, &_::IZX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "BIT", &_::BIT, &_::ZP0 },{ "AND", &_::AND, &_::ZP0 },{ "ROL", &_::ROL, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "PLP", &_::PLP, &_::IMP },{ "AND", &_::AND, &_::IMM },{ "ROL", &_::ROL, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "BIT", &_::BIT, &_::ABS },{ "AND", &_::AND, &_::ABS },{ "ROL", &_::ROL, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BMI", &_::BMI, &_::REL },{ "AND", &_::AND, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "AND", &_::AND, &_::ZPX },{ "ROL", &_::ROL, &_::ZPX },{ "???", &_::NOP, &_::IMP },{ "SEC", &_::SEC, &_::IMP },{ "AND", &_::AND, &_::ABY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "AND", &_::AND, &_::ABX },{ "ROL", &_::ROL, &_::ABX },{ "???", &_::NOP, &_::IMP },
-		{ "RTI", &_::RTI, &_::IMP },{ "EOR", &_::EOR, &_::IZX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "EOR", &_::EOR, &_::ZP0 },{ "LSR", &_::LSR, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "PHA", &_::PHA, &_::IMP },{ "EOR", &_::EOR, &_::IMM },{ "LSR", &_::LSR, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "JMP", &_::JMP, &_::ABS },{ "EOR", &_::EOR, &_::ABS },{ "LSR", &_::LSR, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BVC", &_::BVC, &_::REL },{ "EOR", &_::EOR, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "EOR", &_::EOR, &_::ZPX },{ "LSR", &_::LSR, &_::ZPX },{ "???", &_::NOP, &_::IMP },{ "CLI", &_::CLI, &_::IMP },{ "EOR", &_::EOR, &_::ABY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "EOR", &_::EOR, &_::ABX },{ "LSR", &_::LSR, &_::ABX },{ "???", &_::NOP, &_::IMP },
-		{ "RTS", &_::RTS, &_::IMP },{ "ADC", &_::ADC, &_::IZX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ADC", &_::ADC, &_::ZP0 },{ "ROR", &_::ROR, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "PLA", &_::PLA, &_::IMP },{ "ADC", &_::ADC, &_::IMM },{ "ROR", &_::ROR, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "JMP", &_::JMP, &_::IND },{ "ADC", &_::ADC, &_::ABS },{ "ROR", &_::ROR, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BVS", &_::BVS, &_::REL },{ "ADC", &_::ADC, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ADC", &_::ADC, &_::ZPX },{ "ROR", &_::ROR, &_::ZPX },{ "???", &_::NOP, &_::IMP },{ "SEI", &_::SEI, &_::IMP },{ "ADC", &_::ADC, &_::ABY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "ADC", &_::ADC, &_::ABX },{ "ROR", &_::ROR, &_::ABX },{ "???", &_::NOP, &_::IMP },
-		{ "???", &_::NOP, &_::IMP },{ "STA", &_::STA, &_::IZX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "STY", &_::STY, &_::ZP0 },{ "STA", &_::STA, &_::ZP0 },{ "STX", &_::STX, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "DEY", &_::DEY, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "TXA", &_::TXA, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "STY", &_::STY, &_::ABS },{ "STA", &_::STA, &_::ABS },{ "STX", &_::STX, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BCC", &_::BCC, &_::REL },{ "STA", &_::STA, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "STY", &_::STY, &_::ZPX },{ "STA", &_::STA, &_::ZPX },{ "STX", &_::STX, &_::ZPY },{ "???", &_::NOP, &_::IMP },{ "TYA", &_::TYA, &_::IMP },{ "STA", &_::STA, &_::ABY },{ "TXS", &_::TXS, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "STA", &_::STA, &_::ABX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },
-		{ "LDY", &_::LDY, &_::IMM },{ "LDA", &_::LDA, &_::IZX },{ "LDX", &_::LDX, &_::IMM },{ "???", &_::NOP, &_::IMP },{ "LDY", &_::LDY, &_::ZP0 },{ "LDA", &_::LDA, &_::ZP0 },{ "LDX", &_::LDX, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "TAY", &_::TAY, &_::IMP },{ "LDA", &_::LDA, &_::IMM },{ "TAX", &_::TAX, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "LDY", &_::LDY, &_::ABS },{ "LDA", &_::LDA, &_::ABS },{ "LDX", &_::LDX, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BCS", &_::BCS, &_::REL },{ "LDA", &_::LDA, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "LDY", &_::LDY, &_::ZPX },{ "LDA", &_::LDA, &_::ZPX },{ "LDX", &_::LDX, &_::ZPY },{ "???", &_::NOP, &_::IMP },{ "CLV", &_::CLV, &_::IMP },{ "LDA", &_::LDA, &_::ABY },{ "TSX", &_::TSX, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "LDY", &_::LDY, &_::ABX },{ "LDA", &_::LDA, &_::ABX },{ "LDX", &_::LDX, &_::ABY },{ "???", &_::NOP, &_::IMP },
-		{ "CPY", &_::CPY, &_::IMM },{ "CMP", &_::CMP, &_::IZX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "CPY", &_::CPY, &_::ZP0 },{ "CMP", &_::CMP, &_::ZP0 },{ "DEC", &_::DEC, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "INY", &_::INY, &_::IMP },{ "CMP", &_::CMP, &_::IMM },{ "DEX", &_::DEX, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "CPY", &_::CPY, &_::ABS },{ "CMP", &_::CMP, &_::ABS },{ "DEC", &_::DEC, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BNE", &_::BNE, &_::REL },{ "CMP", &_::CMP, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "CMP", &_::CMP, &_::ZPX },{ "DEC", &_::DEC, &_::ZPX },{ "???", &_::NOP, &_::IMP },{ "CLD", &_::CLD, &_::IMP },{ "CMP", &_::CMP, &_::ABY },{ "NOP", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "CMP", &_::CMP, &_::ABX },{ "DEC", &_::DEC, &_::ABX },{ "???", &_::NOP, &_::IMP },
-		{ "CPX", &_::CPX, &_::IMM },{ "SBC", &_::SBC, &_::IZX },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "CPX", &_::CPX, &_::ZP0 },{ "SBC", &_::SBC, &_::ZP0 },{ "INC", &_::INC, &_::ZP0 },{ "???", &_::NOP, &_::IMP },{ "INX", &_::INX, &_::IMP },{ "SBC", &_::SBC, &_::IMM },{ "NOP", &_::NOP, &_::IMP },{ "???", &_::SBC, &_::IMP },{ "CPX", &_::CPX, &_::ABS },{ "SBC", &_::SBC, &_::ABS },{ "INC", &_::INC, &_::ABS },{ "???", &_::NOP, &_::IMP },
-		{ "BEQ", &_::BEQ, &_::REL },{ "SBC", &_::SBC, &_::IZY },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "SBC", &_::SBC, &_::ZPX },{ "INC", &_::INC, &_::ZPX },{ "???", &_::NOP, &_::IMP },{ "SED", &_::SED, &_::IMP },{ "SBC", &_::SBC, &_::ABY },{ "NOP", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "???", &_::NOP, &_::IMP },{ "SBC", &_::SBC, &_::ABX },{ "INC", &_::INC, &_::ABX },{ "???", &_::NOP, &_::IMP },
-	}};
-  // clang-format on
+  using _ = basic_cpu6502;
+
+#define CONSTEXPR_6502_OPERATION(code, name, operate, addrmode, base_cycles) \
+  &_::instruction<&_::addrmode, &_::operate, base_cycles>,
+#define CONSTEXPR_6502_INSTRUCTION(code, name, operate, addrmode, \
+                                   base_cycles)                   \
+  {name, base_cycles},
+#define CONSTEXPR_6502_PREDECODED(code, name, operate, addrmode, base_cycles) \
+  &_::predecoded_instruction<&_::addrmode, &_::operate, base_cycles>,
+
+  // Hot part of the decode table, one fused handler per opcode, used by
+  // exec() for dispatch. It is shared by all instances rather than copied
+  // into each one.
+  static constexpr std::array<handler, 0x100> lookup = {
+      {CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_OPERATION)}};
+
+  static constexpr std::array<INSTRUCTION, 0x100> metadata = {
+      {CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_INSTRUCTION)}};
+
+  // Handlers used by the decode cache.
+  static constexpr std::array<handler, 0x100> predecoded = {
+      {CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_PREDECODED)}};
+
+#undef CONSTEXPR_6502_OPERATION
+#undef CONSTEXPR_6502_INSTRUCTION
+#undef CONSTEXPR_6502_PREDECODED
+
+ private:
+  // Everything but memory, the trace and the decode cache.
+  constexpr auto copy_registers(const basic_cpu6502& other) -> void {
+    operand = other.operand;
+    operand_word = other.operand_word;
+    opcode = other.opcode;
+    address = other.address;
+    address_rel = other.address_rel;
+    A = other.A;
+    X = other.X;
+    Y = other.Y;
+    PC = other.PC;
+    SP = other.SP;
+    P = other.P;
+    n_flag = other.n_flag;
+    v_flag = other.v_flag;
+    z_flag = other.z_flag;
+    c_flag = other.c_flag;
+    cycles = other.cycles;
+  }
 };
 
+using cpu6502 = basic_cpu6502<>;
+using decode_cache = cpu6502::decode_cache;
+
+// Records the pages written to, for a cheap restore().
+using tracked_cpu6502 = basic_cpu6502<tracked_memory>;
+
+// Undoes up to the last 4096 instructions with step_back().
+using undo_cpu6502 =
+    basic_cpu6502<flat_memory, unchecked, undo_trace<4096>, cycle_timing>;
+
+// Every check, the last 64 instructions and cycles.
+using debug_cpu6502 =
+    basic_cpu6502<flat_memory, checked, ring_trace<64>, cycle_timing>;
+
+// Compares the architectural state (registers, flags and memory) of two cpus,
+// which may use different policies.
+template <typename... Lhs, typename... Rhs>
+constexpr auto same_state(const basic_cpu6502<Lhs...>& lhs,
+                          const basic_cpu6502<Rhs...>& rhs) -> bool {
+  if (lhs.A != rhs.A || lhs.X != rhs.X || lhs.Y != rhs.Y || lhs.PC != rhs.PC ||
+      lhs.SP != rhs.SP || lhs.getFlag() != rhs.getFlag()) {
+    return false;
+  }
+
+  for (int addr = 0; addr < 0x10000; addr++) {
+    if (lhs.read(addr) != rhs.read(addr)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 #endif
@@ -0,0 +1,55 @@
+#ifndef CONSTEXPR_6502_FLAG_H
+#define CONSTEXPR_6502_FLAG_H
+
+#include <type_traits>
+
+// A status flag kept as the value it is derived from. Handlers hand it the
+// raw result of an operation with from(), and the flag is only worked out
+// when it is read, which for N/Z/C/V is mostly never: the next instruction
+// overwrites it first.
+//
+// The flag is set when `input & mask` is non zero, or when it is zero if
+// `inverted`. Assigning a bool stores an input that reads back as that bool.
+template <typename T, T mask, bool inverted = false>
+class lazy_flag {
+  using self = lazy_flag<T, mask, inverted>;
+
+ public:
+  constexpr lazy_flag() = default;
+
+  // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+  constexpr lazy_flag(bool value) : m_input(input_for(value)) {}
+
+  template <typename U>
+  constexpr auto from(U input) -> void {
+    static_assert(std::is_integral_v<U>, "Flags derive from integers...");
+    m_input = static_cast<T>(input);
+  }
+
+  [[nodiscard]] constexpr auto input() const -> T { return m_input; }
+
+  [[nodiscard]] constexpr auto value() const -> bool {
+    return ((m_input & mask) != 0) != inverted;
+  }
+
+  // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+  constexpr operator bool() const { return value(); }
+
+  constexpr auto operator=(bool value) -> self& {
+    m_input = input_for(value);
+    return *this;
+  }
+
+  // Only bools assign directly, anything else has to go through from().
+  template <typename U>
+  auto operator=(U value) -> self& = delete;
+
+ private:
+  static constexpr auto input_for(bool value) -> T {
+    return value != inverted ? mask : T{0};
+  }
+
+  T m_input = input_for(false);
+};
+
+#endif
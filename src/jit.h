@@ -0,0 +1,1254 @@
+#ifndef CONSTEXPR_6502_JIT_H
+#define CONSTEXPR_6502_JIT_H
+
+// Opt-in dynamic recompiler. Not part of core.h, include "jit.h" to use it.
+//
+// On Linux x86-64, jit_engine translates hot basic blocks into native code
+// in mmap'd memory, which is writable while a block is copied in and
+// executable otherwise, never both. Elsewhere it interprets everything, so
+// code using it still builds and behaves the same.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "cache.h"
+#include "common.h"
+#include "cpu.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define CONSTEXPR_6502_HAS_JIT 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define CONSTEXPR_6502_HAS_JIT 0
+#endif
+
+// Guest state lives in callee-saved host registers while a block runs:
+//
+//   rbx  cpu6502*        r12  A        r13  X        r14  Y
+//   r15  last result, N and Z are derived from it (bit 7 / == 0)
+//   rbp  C in bit 0, V in bit 1
+//   r8   SP, saved in cpu6502::SP around calls out of the block
+//
+// Loads read cpu6502::memory directly. Stores to pages without compiled
+// code write cpu6502::memory directly too; stores to the other pages call
+// cpu6502::write(), which invalidates the decode cache, and end the block.
+// The engine then drops all compiled code before running the next one.
+//
+// Pushes and JSR check the stack pages instead, and leave the instruction
+// to the interpreter when one of them holds compiled code. So do other
+// instructions the translator does not handle: they end a block, and the
+// engine runs them on cpu6502::exec() and carries on.
+class jit_engine {
+ public:
+  static constexpr std::size_t code_size = std::size_t{1} << 20;
+  static constexpr std::size_t max_length = 64;
+
+  // Times a PC has to be reached before its block is compiled.
+  static constexpr std::uint8_t threshold = 2;
+
+  static constexpr auto available() -> bool { return CONSTEXPR_6502_HAS_JIT; }
+
+  explicit jit_engine(cpu6502& cpu) : m_cpu(&cpu) {
+    m_cpu->attach(&m_cache);
+
+#if CONSTEXPR_6502_HAS_JIT
+    void* code = mmap(nullptr, code_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code != MAP_FAILED) {  // NOLINT(performance-no-int-to-ptr)
+      m_code = static_cast<byte*>(code);
+    }
+#endif
+  }
+
+  jit_engine(const jit_engine&) = delete;
+  jit_engine(jit_engine&&) = delete;
+  auto operator=(const jit_engine&) -> jit_engine& = delete;
+  auto operator=(jit_engine&&) -> jit_engine& = delete;
+
+  ~jit_engine() {
+    m_cpu->attach(nullptr);
+
+#if CONSTEXPR_6502_HAS_JIT
+    if (m_code != nullptr) {
+      munmap(m_code, code_size);
+    }
+#endif
+  }
+
+  // Same semantics as cpu6502::exec_n().
+  auto exec_n(int value = 1) -> void {
+    while (value > 0) {
+      value -= step(value);
+    }
+  }
+
+  // Same semantics as cpu6502::exec_until_hlt().
+  auto exec_until_hlt() -> void {
+    while (m_cpu->read(m_cpu->PC) != hlt) {
+      step(max_length);
+    }
+    m_cpu->PC++;
+  }
+
+  auto flush() -> void {
+    for (auto pc : m_compiled_pcs) {
+      m_blocks[pc] = {};
+    }
+    m_compiled_pcs.clear();
+    std::fill(m_heat.begin(), m_heat.end(), 0);
+    m_used = 0;
+    m_cache.flush();
+    m_code_writes = m_cache.code_writes;
+  }
+
+  std::uint64_t blocks_compiled = 0;
+  std::uint64_t native_instructions = 0;
+  std::uint64_t interpreted_instructions = 0;
+  std::uint64_t flushes = 0;
+
+ private:
+  static constexpr byte hlt = cpu6502::hlt_opcode;
+
+  // Returns the number of guest instructions retired.
+  using block_fn = std::uint32_t (*)(cpu6502*);
+
+  struct block {
+    block_fn run = nullptr;
+    int length = 0;
+  };
+
+  // Heat value of a PC whose first instruction cannot be translated.
+  static constexpr std::uint8_t cold = 0xff;
+
+  // Runs one compiled block, or one interpreted instruction, and returns how
+  // many instructions ran. Never runs more than `budget`.
+  auto step(int budget) -> int {
+    if (m_cache.code_writes != m_code_writes) {
+      flushes++;
+      flush();
+    }
+
+    auto pc = m_cpu->PC;
+    auto& compiled = m_blocks[pc];
+
+    if (compiled.run == nullptr && m_heat[pc] != cold &&
+        ++m_heat[pc] >= threshold) {
+      compile(pc);
+    }
+
+    // Lazy N/Z cannot represent both set at once, interpret until one clears.
+    // A block that leaves its first instruction to the interpreter retires
+    // nothing, and the interpreter runs it below.
+    if (compiled.run != nullptr && compiled.length <= budget &&
+        !(m_cpu->N() && m_cpu->Z())) {
+      auto count = compiled.run(m_cpu);
+      native_instructions += count;
+      if (count != 0) {
+        return static_cast<int>(count);
+      }
+    }
+
+    m_cpu->exec();
+    interpreted_instructions++;
+    return 1;
+  }
+
+  // Called from generated code for every store. Returns non-zero when the
+  // write landed on a page holding compiled code.
+  static auto write(cpu6502* cpu, std::uint32_t addr, std::uint32_t data)
+      -> std::uint32_t {
+    auto before = cpu->icache->code_writes;
+    cpu->write(static_cast<word>(addr), static_cast<byte>(data));
+    return static_cast<std::uint32_t>(cpu->icache->code_writes != before);
+  }
+
+#if CONSTEXPR_6502_HAS_JIT
+  enum reg : byte {
+    rax = 0,
+    rcx = 1,
+    rdx = 2,
+    rbx = 3,
+    rsp = 4,
+    rbp = 5,
+    rsi = 6,
+    rdi = 7,
+    r8 = 8,
+    r12 = 12,
+    r13 = 13,
+    r14 = 14,
+    r15 = 15,
+  };
+
+  // Guest register assignment, see the comment at the top.
+  static constexpr reg cpu_reg = rbx;
+  static constexpr reg a_reg = r12;
+  static constexpr reg x_reg = r13;
+  static constexpr reg y_reg = r14;
+  static constexpr reg nz_reg = r15;
+  static constexpr reg cv_reg = rbp;
+  static constexpr reg sp_reg = r8;
+
+  enum cond : byte {
+    overflow = 0x0,
+    carry = 0x2,
+    no_carry = 0x3,
+    zero = 0x4,
+    not_zero = 0x5,
+  };
+
+  // Minimal x86-64 encoder for the handful of forms the translator needs.
+  // Memory operands are always rbx relative with a 32 bit displacement.
+  class assembler {
+   public:
+    std::vector<byte> code;
+
+    auto emit(std::initializer_list<byte> bytes) -> void {
+      code.insert(code.end(), bytes);
+    }
+
+    auto imm32(std::uint32_t value) -> void {
+      for (int i = 0; i < 4; i++) {
+        code.push_back(static_cast<byte>(value >> (8 * i)));
+      }
+    }
+
+    auto imm64(std::uint64_t value) -> void {
+      for (int i = 0; i < 8; i++) {
+        code.push_back(static_cast<byte>(value >> (8 * i)));
+      }
+    }
+
+    auto rex(bool w, int r, int x, int b, bool force = false) -> void {
+      auto prefix = static_cast<byte>(0x40 | (w ? 8 : 0) | ((r >> 3) << 2) |
+                                      ((x >> 3) << 1) | (b >> 3));
+      if (prefix != 0x40 || force) {
+        code.push_back(prefix);
+      }
+    }
+
+    auto modrm(int mod, int r, int rm) -> void {
+      code.push_back(static_cast<byte>((mod << 6) | ((r & 7) << 3) | (rm & 7)));
+    }
+
+    // [rbx + disp32]
+    auto mem(int r, std::uint32_t disp) -> void {
+      modrm(2, r, rbx);
+      imm32(disp);
+    }
+
+    // [rbx + index + disp32]
+    auto mem(int r, int index, std::uint32_t disp) -> void {
+      modrm(2, r, rsp);
+      code.push_back(static_cast<byte>(((index & 7) << 3) | rbx));
+      imm32(disp);
+    }
+
+    auto push(int r) -> void {
+      rex(false, 0, 0, r);
+      code.push_back(static_cast<byte>(0x50 + (r & 7)));
+    }
+
+    auto pop(int r) -> void {
+      rex(false, 0, 0, r);
+      code.push_back(static_cast<byte>(0x58 + (r & 7)));
+    }
+
+    auto mov(int dst, std::uint32_t imm) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(static_cast<byte>(0xb8 + (dst & 7)));
+      imm32(imm);
+    }
+
+    auto mov_rr(int dst, int src) -> void {
+      rex(false, src, 0, dst);
+      code.push_back(0x89);
+      modrm(3, src, dst);
+    }
+
+    auto mov64_rr(int dst, int src) -> void {
+      rex(true, src, 0, dst);
+      code.push_back(0x89);
+      modrm(3, src, dst);
+    }
+
+    auto mov64(int dst, std::uint64_t imm) -> void {
+      rex(true, 0, 0, dst);
+      code.push_back(static_cast<byte>(0xb8 + (dst & 7)));
+      imm64(imm);
+    }
+
+    // movzx dst32, src8
+    auto movzx8_rr(int dst, int src) -> void {
+      rex(false, dst, 0, src, src >= 4 && src < 8);
+      emit({0x0f, 0xb6});
+      modrm(3, dst, src);
+    }
+
+    // movzx dst32, src16
+    auto movzx16_rr(int dst, int src) -> void {
+      rex(false, dst, 0, src);
+      emit({0x0f, 0xb7});
+      modrm(3, dst, src);
+    }
+
+    // movzx dst32, byte [rbx + disp]
+    auto load8(int dst, std::uint32_t disp) -> void {
+      rex(false, dst, 0, 0);
+      emit({0x0f, 0xb6});
+      mem(dst, disp);
+    }
+
+    // movzx dst32, word [rbx + disp]
+    auto load16(int dst, std::uint32_t disp) -> void {
+      rex(false, dst, 0, 0);
+      emit({0x0f, 0xb7});
+      mem(dst, disp);
+    }
+
+    // movzx dst32, byte [rbx + index + disp]
+    auto load8(int dst, int index, std::uint32_t disp) -> void {
+      rex(false, dst, index, 0);
+      emit({0x0f, 0xb6});
+      mem(dst, index, disp);
+    }
+
+    // mov byte [rbx + disp], src8
+    auto store8(std::uint32_t disp, int src) -> void {
+      rex(false, src, 0, 0, src >= 4 && src < 8);
+      code.push_back(0x88);
+      mem(src, disp);
+    }
+
+    // mov word [rbx + disp], src16
+    auto store16(std::uint32_t disp, int src) -> void {
+      code.push_back(0x66);
+      rex(false, src, 0, 0);
+      code.push_back(0x89);
+      mem(src, disp);
+    }
+
+    // mov byte [rbx + index + disp], src8
+    auto store8(int index, std::uint32_t disp, int src) -> void {
+      rex(false, src, index, 0, src >= 4 && src < 8);
+      code.push_back(0x88);
+      mem(src, index, disp);
+    }
+
+    // <op> qword [rbx + disp], imm32, op is the /digit of opcode 0x81
+    auto alu64_mem(int ext, std::uint32_t disp, std::uint32_t imm) -> void {
+      rex(true, 0, 0, 0);
+      code.push_back(0x81);
+      mem(ext, disp);
+      imm32(imm);
+    }
+
+    // <op> byte [rbx + disp], imm8, op is the /digit of opcode 0x80
+    auto alu8_mem(int ext, std::uint32_t disp, byte imm) -> void {
+      code.push_back(0x80);
+      mem(ext, disp);
+      code.push_back(imm);
+    }
+
+    // mov word [rbx + disp], imm16
+    auto store16_imm(std::uint32_t disp, word imm) -> void {
+      emit({0x66, 0xc7});
+      mem(0, disp);
+      code.push_back(static_cast<byte>(imm));
+      code.push_back(static_cast<byte>(imm >> 8));
+    }
+
+    // <op> dst8, src8 where op is the "r/m8, r8" opcode byte
+    auto alu8(byte op, int dst, int src) -> void {
+      rex(false, src, 0, dst);
+      code.push_back(op);
+      modrm(3, src, dst);
+    }
+
+    // <op> dst32, imm8 (sign extended), op is the /digit of opcode 0x83
+    auto alu32(int ext, int dst, std::int8_t imm) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(0x83);
+      modrm(3, ext, dst);
+      code.push_back(static_cast<byte>(imm));
+    }
+
+    // <op> dst32, src32 where op is the "r/m32, r32" opcode byte
+    auto alu32_rr(byte op, int dst, int src) -> void {
+      rex(false, src, 0, dst);
+      code.push_back(op);
+      modrm(3, src, dst);
+    }
+
+    // lea dst32, [base + disp32]
+    auto lea(int dst, int base, std::uint32_t disp) -> void {
+      rex(false, dst, 0, base);
+      code.push_back(0x8d);
+      modrm(2, dst, base);
+      imm32(disp);
+    }
+
+    auto shl(int dst, byte count) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(0xc1);
+      modrm(3, 4, dst);
+      code.push_back(count);
+    }
+
+    // One operand byte forms: 0xfe /0 inc, /1 dec; 0xf6 /2 not;
+    // 0xd0 /2 rcl, /3 rcr, /4 shl, /5 shr.
+    auto unary8(byte op, int ext, int dst) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(op);
+      modrm(3, ext, dst);
+    }
+
+    auto shr(int dst, byte count) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(0xc1);
+      modrm(3, 5, dst);
+      code.push_back(count);
+    }
+
+    auto neg(int dst) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(0xf7);
+      modrm(3, 3, dst);
+    }
+
+    auto setcc(cond cc, int dst) -> void {
+      rex(false, 0, 0, dst);
+      emit({0x0f, static_cast<byte>(0x90 + cc)});
+      modrm(3, 0, dst);
+    }
+
+    auto test8(int dst, byte imm) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(0xf6);
+      modrm(3, 0, dst);
+      code.push_back(imm);
+    }
+
+    auto test8_rr(int lhs, int rhs) -> void {
+      rex(false, rhs, 0, lhs);
+      code.push_back(0x84);
+      modrm(3, rhs, lhs);
+    }
+
+    // test byte [base], imm8
+    auto test8_mem(int base, byte imm) -> void {
+      rex(false, 0, 0, base);
+      code.push_back(0xf6);
+      modrm(0, 0, base);
+      code.push_back(imm);
+    }
+
+    auto test32(int dst, std::uint32_t imm) -> void {
+      rex(false, 0, 0, dst);
+      code.push_back(0xf7);
+      modrm(3, 0, dst);
+      imm32(imm);
+    }
+
+    // bt dst32, bit
+    auto bt(int dst, byte bit) -> void {
+      rex(false, 0, 0, dst);
+      emit({0x0f, 0xba});
+      modrm(3, 4, dst);
+      code.push_back(bit);
+    }
+
+    // bt dword [base], bit where bit may index past the first dword
+    auto bt_mem(int base, int bit) -> void {
+      rex(false, bit, 0, base);
+      emit({0x0f, 0xa3});
+      modrm(0, bit, base);
+    }
+
+    auto call(int target) -> void {
+      rex(false, 0, 0, target);
+      code.push_back(0xff);
+      modrm(3, 2, target);
+    }
+
+    // Returns the offset of the rel32 to patch.
+    auto jcc(cond cc) -> std::size_t {
+      emit({0x0f, static_cast<byte>(0x80 + cc)});
+      imm32(0);
+      return code.size() - 4;
+    }
+
+    auto jmp() -> std::size_t {
+      code.push_back(0xe9);
+      imm32(0);
+      return code.size() - 4;
+    }
+
+    // Points the rel32 at `at` to the current end of code.
+    auto bind(std::size_t at) -> void {
+      auto rel = static_cast<std::uint32_t>(code.size() - (at + 4));
+      std::memcpy(&code[at], &rel, sizeof(rel));
+    }
+  };
+
+  // Displacements of cpu6502 members from the cpu pointer in rbx.
+  static constexpr std::uint32_t A = offsetof(cpu6502, A);
+  static constexpr std::uint32_t X = offsetof(cpu6502, X);
+  static constexpr std::uint32_t Y = offsetof(cpu6502, Y);
+  static constexpr std::uint32_t PC = offsetof(cpu6502, PC);
+  static constexpr std::uint32_t SP = offsetof(cpu6502, SP);
+  static constexpr std::uint32_t P = offsetof(cpu6502, P);
+  static constexpr std::uint32_t N = offsetof(cpu6502, n_flag);
+  static constexpr std::uint32_t V = offsetof(cpu6502, v_flag);
+  static constexpr std::uint32_t Z = offsetof(cpu6502, z_flag);
+  static constexpr std::uint32_t C = offsetof(cpu6502, c_flag);
+  static constexpr std::uint32_t memory = offsetof(cpu6502, memory.bytes);
+  static constexpr std::uint32_t cycles = offsetof(cpu6502, cycles);
+
+  enum class mode { IMP, IMM, ZP0, ZPX, ZPY, REL,
+                    ABS, ABX, ABY, IND, IZX, IZY };
+
+  static constexpr auto mode_of(byte opcode) -> mode {
+#define CONSTEXPR_6502_MODE(code, name, operate, addrmode, base_cycles) \
+  case code:                                                            \
+    return mode::addrmode;
+
+    switch (opcode) { CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_MODE) }
+
+#undef CONSTEXPR_6502_MODE
+
+    return mode::IMP;
+  }
+
+  // Operations the translator handles, by the handler of the opcode table.
+  enum class operation {
+    other, ADC, AND, ASL, BCC, BCS, BEQ, BMI, BNE, BPL, BVC, BVS, CLC,
+    CLD,   CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY,
+    JMP,   JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL,
+    ROR,   RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TXA, TYA
+  };
+
+  using _ = cpu6502;
+
+  // Read-modify-write handlers are instantiated on their addressing mode.
+  template <cpu6502::handler operate, cpu6502::handler addrmode>
+  static constexpr auto operation_of() -> operation {
+    // clang-format off
+    if constexpr (operate == &_::ADC) { return operation::ADC; }
+    else if constexpr (operate == &_::AND) { return operation::AND; }
+    else if constexpr (operate == &_::ASL<addrmode>) { return operation::ASL; }
+    else if constexpr (operate == &_::BCC) { return operation::BCC; }
+    else if constexpr (operate == &_::BCS) { return operation::BCS; }
+    else if constexpr (operate == &_::BEQ) { return operation::BEQ; }
+    else if constexpr (operate == &_::BMI) { return operation::BMI; }
+    else if constexpr (operate == &_::BNE) { return operation::BNE; }
+    else if constexpr (operate == &_::BPL) { return operation::BPL; }
+    else if constexpr (operate == &_::BVC) { return operation::BVC; }
+    else if constexpr (operate == &_::BVS) { return operation::BVS; }
+    else if constexpr (operate == &_::CLC) { return operation::CLC; }
+    else if constexpr (operate == &_::CLD) { return operation::CLD; }
+    else if constexpr (operate == &_::CLI) { return operation::CLI; }
+    else if constexpr (operate == &_::CLV) { return operation::CLV; }
+    else if constexpr (operate == &_::CMP) { return operation::CMP; }
+    else if constexpr (operate == &_::CPX) { return operation::CPX; }
+    else if constexpr (operate == &_::CPY) { return operation::CPY; }
+    else if constexpr (operate == &_::DEC) { return operation::DEC; }
+    else if constexpr (operate == &_::DEX) { return operation::DEX; }
+    else if constexpr (operate == &_::DEY) { return operation::DEY; }
+    else if constexpr (operate == &_::EOR) { return operation::EOR; }
+    else if constexpr (operate == &_::INC) { return operation::INC; }
+    else if constexpr (operate == &_::INX) { return operation::INX; }
+    else if constexpr (operate == &_::INY) { return operation::INY; }
+    else if constexpr (operate == &_::JMP) { return operation::JMP; }
+    else if constexpr (operate == &_::JSR) { return operation::JSR; }
+    else if constexpr (operate == &_::LDA) { return operation::LDA; }
+    else if constexpr (operate == &_::LDX) { return operation::LDX; }
+    else if constexpr (operate == &_::LDY) { return operation::LDY; }
+    else if constexpr (operate == &_::LSR<addrmode>) { return operation::LSR; }
+    else if constexpr (operate == &_::NOP) { return operation::NOP; }
+    else if constexpr (operate == &_::ORA) { return operation::ORA; }
+    else if constexpr (operate == &_::PHA) { return operation::PHA; }
+    else if constexpr (operate == &_::PHP) { return operation::PHP; }
+    else if constexpr (operate == &_::PLA) { return operation::PLA; }
+    else if constexpr (operate == &_::PLP) { return operation::PLP; }
+    else if constexpr (operate == &_::ROL<addrmode>) { return operation::ROL; }
+    else if constexpr (operate == &_::ROR<addrmode>) { return operation::ROR; }
+    else if constexpr (operate == &_::RTS) { return operation::RTS; }
+    else if constexpr (operate == &_::SBC) { return operation::SBC; }
+    else if constexpr (operate == &_::SEC) { return operation::SEC; }
+    else if constexpr (operate == &_::SED) { return operation::SED; }
+    else if constexpr (operate == &_::SEI) { return operation::SEI; }
+    else if constexpr (operate == &_::STA) { return operation::STA; }
+    else if constexpr (operate == &_::STX) { return operation::STX; }
+    else if constexpr (operate == &_::STY) { return operation::STY; }
+    else if constexpr (operate == &_::TAX) { return operation::TAX; }
+    else if constexpr (operate == &_::TAY) { return operation::TAY; }
+    else if constexpr (operate == &_::TXA) { return operation::TXA; }
+    else if constexpr (operate == &_::TYA) { return operation::TYA; }
+    else { return operation::other; }
+    // clang-format on
+  }
+
+  static constexpr auto operation_of(byte opcode) -> operation {
+#define CONSTEXPR_6502_OPERATION(code, name, operate, addrmode, base_cycles) \
+  case code:                                                                 \
+    return operation_of<&_::operate, &_::addrmode>();
+
+    switch (opcode) { CONSTEXPR_6502_OPCODES(CONSTEXPR_6502_OPERATION) }
+
+#undef CONSTEXPR_6502_OPERATION
+
+    return operation::other;
+  }
+
+  // Block under construction. Every exit jumps to one shared epilogue.
+  struct translation {
+    assembler as;
+    std::vector<std::size_t> exits;
+    const std::uint64_t* code_pages;
+    // Base cycles of the instructions translated so far.
+    std::uint32_t cycles = 0;
+  };
+
+  static auto prologue(assembler& as) -> void {
+    for (auto r : {rbx, rbp, r12, r13, r14, r15}) {
+      as.push(r);
+    }
+    as.emit({0x48, 0x83, 0xec, 0x08});  // sub rsp, 8
+    as.mov64_rr(cpu_reg, rdi);
+
+    as.load8(a_reg, A);
+    as.load8(x_reg, X);
+    as.load8(y_reg, Y);
+    as.load8(sp_reg, SP);
+
+    // nz = Z ? 0 : (N << 7 | 1)
+    as.load8(rax, N);
+    as.alu32(4, rax, -0x80);
+    as.alu32(1, rax, 1);
+    as.load8(rcx, Z);
+    as.neg(rcx);
+    as.alu32_rr(0x19, rcx, rcx);
+    as.alu32_rr(0x21, rax, rcx);
+    as.mov_rr(nz_reg, rax);
+
+    // cv = C | V << 1
+    as.load16(cv_reg, C);
+    as.shr(cv_reg, 8);
+    as.alu32(4, cv_reg, 1);
+    as.load8(rax, V);
+    as.shr(rax, 7);
+    as.shl(rax, 1);
+    as.alu32_rr(0x09, cv_reg, rax);
+  }
+
+  static auto epilogue(assembler& as) -> void {
+    as.store8(A, a_reg);
+    as.store8(X, x_reg);
+    as.store8(Y, y_reg);
+    as.store8(SP, sp_reg);
+
+    // eax holds the instruction count. The lazy flags take their inputs
+    // straight from nz and cv.
+    as.store8(Z, nz_reg);
+    as.store8(N, nz_reg);
+    as.mov_rr(rcx, cv_reg);
+    as.alu32(4, rcx, 1);
+    as.shl(rcx, 8);
+    as.store16(C, rcx);
+    as.mov_rr(rcx, cv_reg);
+    as.alu32(4, rcx, 2);
+    as.shl(rcx, 6);
+    as.store8(V, rcx);
+
+    as.emit({0x48, 0x83, 0xc4, 0x08});  // add rsp, 8
+    for (auto r : {r15, r14, r13, r12, rbp, rbx}) {
+      as.pop(r);
+    }
+    as.emit({0xc3});  // ret
+  }
+
+  // Leaves the block with PC = pc, reporting `count` retired instructions.
+  // Adds the base cycles so far, plus `extra`.
+  static auto exit(translation& block, word pc, int count,
+                   std::uint32_t extra = 0) -> void {
+    block.as.store16_imm(PC, pc);
+    leave(block, count, extra);
+  }
+
+  // exit() for a PC already stored.
+  static auto leave(translation& block, int count, std::uint32_t extra = 0)
+      -> void {
+    block.as.alu64_mem(0, cycles, block.cycles + extra);
+    block.as.mov(rax, static_cast<std::uint32_t>(count));
+    block.exits.push_back(block.as.jmp());
+  }
+
+  // Leaves the block before `op`, the instruction being translated, for the
+  // interpreter to run it. Nothing of `op` may have run yet.
+  static auto bail(translation& block, const decode_cache::entry& op,
+                   int count) -> void {
+    auto total = block.cycles;
+    block.cycles -= cpu6502::metadata[op.opcode].cycles;
+    exit(block, op.pc, count);
+    block.cycles = total;
+  }
+
+  // Bails out of `op` when one of the first 8 pages in the bit mask `pages`
+  // holds compiled code. Pushes check the stack page this way rather than
+  // going through write().
+  static auto guard(translation& block, const decode_cache::entry& op,
+                    int count, byte pages) -> void {
+    auto& as = block.as;
+    as.mov64(rsi, reinterpret_cast<std::uint64_t>(block.code_pages));
+    as.test8_mem(rsi, pages);
+    auto clear = as.jcc(zero);
+    bail(block, op, count);
+    as.bind(clear);
+  }
+
+  // Effective address into eax. False for modes that are not translated.
+  static auto effective_address(assembler& as, mode m, word arg) -> bool {
+    switch (m) {
+      case mode::ZP0:
+        as.mov(rax, arg & 0x00ff);
+        return true;
+      case mode::ZPX:
+      case mode::ZPY:
+        as.lea(rax, m == mode::ZPX ? x_reg : y_reg, arg);
+        as.movzx8_rr(rax, rax);
+        return true;
+      case mode::ABS:
+        as.mov(rax, arg);
+        return true;
+      case mode::ABX:
+      case mode::ABY:
+        as.lea(rax, m == mode::ABX ? x_reg : y_reg, arg);
+        as.movzx16_rr(rax, rax);
+        return true;
+      case mode::IZX:
+        as.lea(rcx, x_reg, arg);
+        as.movzx8_rr(rcx, rcx);
+        as.load8(rax, rcx, memory);
+        as.alu32(0, rcx, 1);
+        as.movzx8_rr(rcx, rcx);
+        as.load8(rcx, rcx, memory);
+        as.shl(rcx, 8);
+        as.alu32_rr(0x09, rax, rcx);
+        return true;
+      case mode::IZY:
+        as.load8(rax, memory + (arg & 0x00ff));
+        as.load8(rcx, memory + ((arg + 1) & 0x00ff));
+        as.shl(rcx, 8);
+        as.alu32_rr(0x09, rax, rcx);
+        as.alu32_rr(0x01, rax, y_reg);
+        as.movzx16_rr(rax, rax);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // Operand value into ecx. Only reads go through here, so it also counts
+  // the page crossing cycle of ABX, ABY and IZY.
+  static auto operand(assembler& as, mode m, word arg) -> bool {
+    if (m == mode::IMM) {
+      as.mov(rcx, arg & 0x00ff);
+      return true;
+    }
+
+    if (!effective_address(as, m, arg)) {
+      return false;
+    }
+
+    if (m == mode::ABX || m == mode::ABY || m == mode::IZY) {
+      // Adding the index wrapped the low byte iff it is now below the index.
+      as.alu8(0x38, rax, m == mode::ABX ? x_reg : y_reg);
+      as.alu64_mem(2, cycles, 0);
+    }
+
+    as.load8(rcx, rax, memory);
+    return true;
+  }
+
+  // Stores the low byte of src to the address in eax. Pages without code
+  // are written directly, the rest go through write() and leave the block
+  // if the store hit compiled code.
+  static auto store(translation& block, int src, word next, int count) -> void {
+    auto& as = block.as;
+
+    as.mov_rr(rdx, rax);
+    as.shr(rdx, 8);
+    as.mov64(rsi, reinterpret_cast<std::uint64_t>(block.code_pages));
+    as.bt_mem(rsi, rdx);
+    auto slow = as.jcc(carry);
+    as.store8(rax, memory, src);
+    auto done = as.jmp();
+
+    as.bind(slow);
+    as.mov_rr(rsi, rax);
+    as.movzx8_rr(rdx, src);
+    as.mov64_rr(rdi, cpu_reg);
+    as.store8(SP, sp_reg);
+    as.mov64(rax, reinterpret_cast<std::uint64_t>(&jit_engine::write));
+    as.call(rax);
+    as.load8(sp_reg, SP);
+    as.test8_rr(rax, rax);
+
+    auto skip = as.jcc(zero);
+    exit(block, next, count);
+    as.bind(skip);
+    as.bind(done);
+  }
+
+  // C = carry flag, and V = overflow flag too if `overflow` is set.
+  static auto carry_out(assembler& as, bool with_overflow) -> void {
+    as.setcc(carry, rax);
+    as.movzx8_rr(rax, rax);
+
+    if (with_overflow) {
+      as.setcc(overflow, rdx);
+      as.movzx8_rr(rdx, rdx);
+      as.shl(rdx, 1);
+      as.alu32_rr(0x09, rax, rdx);
+      as.mov_rr(cv_reg, rax);
+    } else {
+      as.alu32(4, cv_reg, -2);
+      as.alu32_rr(0x09, cv_reg, rax);
+    }
+  }
+
+  // Emits one instruction. `count` instructions precede it in the block.
+  // Returns false, emitting nothing, if it is not translated.
+  static auto translate(translation& block, const decode_cache::entry& op,
+                        int count) -> bool {
+    auto& as = block.as;
+    auto m = mode_of(op.opcode);
+    auto arg = op.operand;
+    auto next = static_cast<word>(op.pc + op.length);
+    auto done = count + 1;
+
+    auto load = [&](int target) {
+      if (!operand(as, m, arg)) {
+        return false;
+      }
+      as.movzx8_rr(target, rcx);
+      as.mov_rr(nz_reg, target);
+      return true;
+    };
+
+    auto store_reg = [&](int src) {
+      if (!effective_address(as, m, arg)) {
+        return false;
+      }
+      store(block, src, next, done);
+      return true;
+    };
+
+    auto logic = [&](byte opcode) {
+      if (!operand(as, m, arg)) {
+        return false;
+      }
+      as.alu8(opcode, a_reg, rcx);
+      as.mov_rr(nz_reg, a_reg);
+      return true;
+    };
+
+    auto add = [&](bool subtract) {
+      if (!operand(as, m, arg)) {
+        return false;
+      }
+      if (subtract) {
+        as.unary8(0xf6, 2, rcx);
+      }
+      as.bt(cv_reg, 0);
+      as.alu8(0x10, a_reg, rcx);
+      carry_out(as, true);
+      as.mov_rr(nz_reg, a_reg);
+      return true;
+    };
+
+    auto compare = [&](int reg) {
+      if (!operand(as, m, arg)) {
+        return false;
+      }
+      as.mov_rr(rax, reg);
+      as.alu8(0x28, rax, rcx);
+      as.setcc(no_carry, rdx);
+      as.movzx8_rr(nz_reg, rax);
+      as.alu32(4, cv_reg, -2);
+      as.movzx8_rr(rdx, rdx);
+      as.alu32_rr(0x09, cv_reg, rdx);
+      return true;
+    };
+
+    auto step = [&](int reg, int ext) {
+      as.unary8(0xfe, ext, reg);
+      as.mov_rr(nz_reg, reg);
+      return true;
+    };
+
+    auto transfer = [&](int dst, int src) {
+      as.mov_rr(dst, src);
+      as.mov_rr(nz_reg, dst);
+      return true;
+    };
+
+    // INC and DEC on memory
+    auto modify = [&](int ext) {
+      if (!effective_address(as, m, arg)) {
+        return false;
+      }
+      as.load8(rcx, rax, memory);
+      as.unary8(0xfe, ext, rcx);
+      as.movzx8_rr(nz_reg, rcx);
+      store(block, rcx, next, done);
+      return true;
+    };
+
+    // ASL, LSR, ROL and ROR, on A or on memory
+    auto shift = [&](int ext, bool rotate) {
+      int target = a_reg;
+      if (m != mode::IMP) {
+        if (!effective_address(as, m, arg)) {
+          return false;
+        }
+        as.load8(rcx, rax, memory);
+        target = rcx;
+      }
+      if (rotate) {
+        as.bt(cv_reg, 0);
+      }
+      as.unary8(0xd0, ext, target);
+      as.setcc(carry, rdx);
+      as.movzx8_rr(rdx, rdx);
+      as.alu32(4, cv_reg, -2);
+      as.alu32_rr(0x09, cv_reg, rdx);
+      as.movzx8_rr(nz_reg, target);
+      if (m != mode::IMP) {
+        store(block, rcx, next, done);
+      }
+      return true;
+    };
+
+    auto branch = [&](int reg, std::uint32_t mask, cond taken) {
+      if (reg == cv_reg) {
+        as.test32(reg, mask);
+      } else if (mask == 0xff) {
+        as.test8_rr(reg, reg);
+      } else {
+        as.test8(reg, static_cast<byte>(mask));
+      }
+
+      auto target = static_cast<word>(next + to_signed(static_cast<byte>(arg)));
+      auto crossed = (target & 0xff00) != (next & 0xff00);
+
+      auto jump = as.jcc(taken);
+      exit(block, next, done);
+      as.bind(jump);
+      exit(block, target, done, crossed ? 2 : 1);
+      return true;
+    };
+
+    auto flag = [&](byte mask, bool value) {
+      if (value) {
+        as.alu8_mem(1, P, mask);
+      } else {
+        as.alu8_mem(4, P, static_cast<byte>(~mask));
+      }
+      return true;
+    };
+
+    // PHA and PHP, `src` is pushed at $0100 + SP.
+    auto push = [&](int src) {
+      as.store8(sp_reg, memory + 0x100, src);
+      as.unary8(0xfe, 1, sp_reg);
+      return true;
+    };
+
+    // getFlag() with B set into ecx, then B cleared, for PHP.
+    auto pack_flags = [&] {
+      guard(block, op, count, 0b00000010);
+      as.load8(rcx, P);
+      as.alu32(4, rcx, 0x3c);
+      as.alu32(1, rcx, 0x10);
+      as.mov_rr(rax, nz_reg);
+      as.alu32(4, rax, -0x80);
+      as.alu32_rr(0x09, rcx, rax);
+      as.test8_rr(nz_reg, nz_reg);
+      as.setcc(zero, rax);
+      as.movzx8_rr(rax, rax);
+      as.shl(rax, 1);
+      as.alu32_rr(0x09, rcx, rax);
+      as.mov_rr(rax, cv_reg);
+      as.alu32(4, rax, 1);
+      as.alu32_rr(0x09, rcx, rax);
+      as.mov_rr(rax, cv_reg);
+      as.alu32(4, rax, 2);
+      as.shl(rax, 5);
+      as.alu32_rr(0x09, rcx, rax);
+      flag(0b00010000, false);
+      return push(rcx);
+    };
+
+    // setFlag() of the byte pulled, for PLP. Leaves a byte with both N and
+    // Z set, which nz cannot hold, to the interpreter.
+    auto pull_flags = [&] {
+      as.mov_rr(rax, sp_reg);
+      as.unary8(0xfe, 0, rax);
+      as.load8(rcx, rax, memory + 0x100);
+      as.test8(rcx, 0x02);
+      auto not_zero = as.jcc(zero);
+      as.test8(rcx, 0x80);
+      auto not_negative = as.jcc(zero);
+      bail(block, op, count);
+      as.bind(not_zero);
+      as.bind(not_negative);
+      as.mov_rr(sp_reg, rax);
+
+      as.mov_rr(rax, rcx);
+      as.alu32(4, rax, 0x3c);
+      as.alu32(1, rax, 0x20);
+      as.store8(P, rax);
+
+      // nz = Z ? 0 : (N << 7 | 1)
+      as.mov_rr(rax, rcx);
+      as.alu32(4, rax, -0x80);
+      as.alu32(1, rax, 1);
+      as.mov_rr(rdx, rcx);
+      as.shr(rdx, 1);
+      as.alu32(4, rdx, 1);
+      as.alu32(5, rdx, 1);
+      as.alu32_rr(0x21, rax, rdx);
+      as.mov_rr(nz_reg, rax);
+
+      // cv = C | V << 1
+      as.mov_rr(rax, rcx);
+      as.alu32(4, rax, 1);
+      as.mov_rr(rdx, rcx);
+      as.shr(rdx, 5);
+      as.alu32(4, rdx, 2);
+      as.alu32_rr(0x09, rax, rdx);
+      as.mov_rr(cv_reg, rax);
+      return true;
+    };
+
+    auto pull = [&] {
+      as.unary8(0xfe, 0, sp_reg);
+      as.load8(a_reg, sp_reg, memory + 0x100);
+      as.mov_rr(nz_reg, a_reg);
+      return true;
+    };
+
+    // As cpu6502::JSR(), the return address minus one goes to $0100 + SP,
+    // low byte first, which may reach into $0200.
+    auto call = [&] {
+      guard(block, op, count, 0b00000110);
+      auto ret = static_cast<word>(next - 1);
+      as.mov(rcx, ret & 0x00ff);
+      as.store8(sp_reg, memory + 0x100, rcx);
+      as.mov(rcx, ret >> 8);
+      as.store8(sp_reg, memory + 0x101, rcx);
+      as.alu32(5, sp_reg, 2);
+      as.movzx8_rr(sp_reg, sp_reg);
+      exit(block, arg, done);
+      return true;
+    };
+
+    auto ret = [&] {
+      as.unary8(0xfe, 0, sp_reg);
+      as.load8(rcx, sp_reg, memory + 0x100);
+      as.load8(rdx, sp_reg, memory + 0x101);
+      as.shl(rdx, 8);
+      as.alu32_rr(0x09, rcx, rdx);
+      as.alu32(0, rcx, 1);
+      as.store16(PC, rcx);
+      leave(block, done);
+      return true;
+    };
+
+    // clang-format off
+    switch (operation_of(op.opcode)) {
+      case operation::LDA: return load(a_reg);
+      case operation::LDX: return load(x_reg);
+      case operation::LDY: return load(y_reg);
+      case operation::STA: return store_reg(a_reg);
+      case operation::STX: return store_reg(x_reg);
+      case operation::STY: return store_reg(y_reg);
+      case operation::AND: return logic(0x20);
+      case operation::ORA: return logic(0x08);
+      case operation::EOR: return logic(0x30);
+      case operation::ADC: return add(false);
+      case operation::SBC: return add(true);
+      case operation::CMP: return compare(a_reg);
+      case operation::CPX: return compare(x_reg);
+      case operation::CPY: return compare(y_reg);
+      case operation::INC: return modify(0);
+      case operation::DEC: return modify(1);
+      case operation::INX: return step(x_reg, 0);
+      case operation::INY: return step(y_reg, 0);
+      case operation::DEX: return step(x_reg, 1);
+      case operation::DEY: return step(y_reg, 1);
+      case operation::TAX: return transfer(x_reg, a_reg);
+      case operation::TAY: return transfer(y_reg, a_reg);
+      case operation::TXA: return transfer(a_reg, x_reg);
+      case operation::TYA: return transfer(a_reg, y_reg);
+      case operation::ASL: return shift(4, false);
+      case operation::LSR: return shift(5, false);
+      case operation::ROL: return shift(2, true);
+      case operation::ROR: return shift(3, true);
+      case operation::CLC: as.alu32(4, cv_reg, -2); return true;
+      case operation::SEC: as.alu32(1, cv_reg, 1); return true;
+      case operation::CLV: as.alu32(4, cv_reg, -3); return true;
+      case operation::CLD: return flag(0b00001000, false);
+      case operation::SED: return flag(0b00001000, true);
+      case operation::CLI: return flag(0b00000100, false);
+      case operation::SEI: return flag(0b00000100, true);
+      case operation::NOP: return true;
+      case operation::PHA:
+        guard(block, op, count, 0b00000010);
+        return push(a_reg);
+      case operation::PHP: return pack_flags();
+      case operation::PLA: return pull();
+      case operation::PLP: return pull_flags();
+      case operation::JSR: return call();
+      case operation::RTS: return ret();
+      case operation::BPL: return branch(nz_reg, 0x80, zero);
+      case operation::BMI: return branch(nz_reg, 0x80, not_zero);
+      case operation::BNE: return branch(nz_reg, 0xff, not_zero);
+      case operation::BEQ: return branch(nz_reg, 0xff, zero);
+      case operation::BCC: return branch(cv_reg, 0x01, zero);
+      case operation::BCS: return branch(cv_reg, 0x01, not_zero);
+      case operation::BVC: return branch(cv_reg, 0x02, zero);
+      case operation::BVS: return branch(cv_reg, 0x02, not_zero);
+      case operation::JMP:
+        if (m != mode::ABS) { return false; }
+        exit(block, arg, done);
+        return true;
+      case operation::other: return false;
+    }
+    // clang-format on
+
+    return false;
+  }
+
+  // Whether translate() already emitted the exits of this instruction.
+  static auto ends_block(byte opcode) -> bool {
+    return mode_of(opcode) == mode::REL || opcode == 0x4c ||  // JMP abs
+           opcode == 0x20 || opcode == 0x60;                  // JSR, RTS
+  }
+#endif
+
+  // Translates the block at pc. Leaves it uncompiled and marks pc cold if
+  // its first instruction cannot be translated.
+  auto compile(word pc) -> void {
+#if CONSTEXPR_6502_HAS_JIT
+    if (m_code == nullptr) {
+      m_heat[pc] = cold;
+      return;
+    }
+
+    translation block{{}, {}, m_cache.code_pages().data()};
+    prologue(block.as);
+
+    int count = 0;
+    bool ended = false;
+    auto at = pc;
+
+    while (count < static_cast<int>(max_length)) {
+      decode_cache::entry op;
+      m_cpu->decode(at, op);
+
+      if (op.opcode == hlt) {
+        break;
+      }
+
+      auto cycles_before = block.cycles;
+      block.cycles += cpu6502::metadata[op.opcode].cycles;
+      if (!translate(block, op, count)) {
+        block.cycles = cycles_before;
+        break;
+      }
+
+      m_cache.mark(at, op.length);
+      count++;
+      at += op.length;
+
+      if (ends_block(op.opcode)) {
+        ended = true;
+        break;
+      }
+    }
+
+    if (count == 0) {
+      m_heat[pc] = cold;
+      return;
+    }
+
+    if (!ended) {
+      exit(block, at, count);
+    }
+
+    for (auto jump : block.exits) {
+      block.as.bind(jump);
+    }
+    epilogue(block.as);
+
+    const auto& code = block.as.code;
+    if (m_used + code.size() > code_size) {
+      flushes++;
+      flush();
+      // flush() unmarked the pages, mark them again.
+      for (word mark = pc; mark != at; mark++) {
+        m_cache.mark(mark, 1);
+      }
+    }
+
+    auto* entry = m_code + m_used;
+    if (!copy_code(entry, code)) {
+      m_heat[pc] = cold;
+      return;
+    }
+    m_used += code.size();
+
+    m_blocks[pc] = {reinterpret_cast<block_fn>(entry), count};
+    m_compiled_pcs.push_back(pc);
+    blocks_compiled++;
+#else
+    m_heat[pc] = cold;
+#endif
+  }
+
+#if CONSTEXPR_6502_HAS_JIT
+  // Copies `code` to `entry` in the code buffer. The pages it spans are
+  // writable while it does, and executable again before it returns.
+  auto copy_code(byte* entry, const std::vector<byte>& code) -> bool {
+    auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    auto first = static_cast<std::size_t>(entry - m_code) / page * page;
+    auto* begin = m_code + first;
+    auto size = static_cast<std::size_t>(entry - begin) + code.size();
+
+    if (mprotect(begin, size, PROT_READ | PROT_WRITE) != 0) {
+      return false;
+    }
+    std::memcpy(entry, code.data(), code.size());
+    return mprotect(begin, size, PROT_READ | PROT_EXEC) == 0;
+  }
+#endif
+
+  cpu6502* m_cpu;
+  decode_cache m_cache;
+  std::uint64_t m_code_writes = 0;
+
+  byte* m_code = nullptr;
+  std::size_t m_used = 0;
+
+  std::vector<block> m_blocks = std::vector<block>(0x10000);
+  std::vector<std::uint8_t> m_heat = std::vector<std::uint8_t>(0x10000);
+  std::vector<word> m_compiled_pcs;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef CONSTEXPR_6502_LANES_H
+#define CONSTEXPR_6502_LANES_H
+
+#include <cstddef>
+
+#include "common.h"
+
+#if defined(__AVX2__)
+#define CONSTEXPR_6502_LANES_WIDE 1
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define CONSTEXPR_6502_LANES_WIDE 1
+#include <emmintrin.h>
+#else
+#define CONSTEXPR_6502_LANES_WIDE 0
+#endif
+
+// Byte vectors for the kernels of cpu6502_bank, one byte per lane: 32 lanes
+// to a vector with AVX2, 16 with SSE2. `one` has the same operations on a
+// single lane, for the lanes left over and for targets without either, so
+// a kernel is written once for both.
+//
+// Every operation works on each byte on its own, and masks are 0xff where
+// true and 0x00 where false.
+namespace lanes {
+
+struct one {
+  static constexpr std::size_t width = 1;
+
+  static auto load(const byte* at) -> one { return {*at}; }
+  static auto splat(byte value) -> one { return {value}; }
+  auto store(byte* at) const -> void { *at = v; }
+
+  byte v;
+};
+
+inline auto operator+(one a, one b) -> one {
+  return {static_cast<byte>(a.v + b.v)};
+}
+inline auto operator-(one a, one b) -> one {
+  return {static_cast<byte>(a.v - b.v)};
+}
+inline auto operator&(one a, one b) -> one {
+  return {static_cast<byte>(a.v & b.v)};
+}
+inline auto operator|(one a, one b) -> one {
+  return {static_cast<byte>(a.v | b.v)};
+}
+inline auto operator^(one a, one b) -> one {
+  return {static_cast<byte>(a.v ^ b.v)};
+}
+
+// Addition that sticks at 0xff.
+inline auto adds(one a, one b) -> one {
+  return {static_cast<byte>(a.v + b.v > 0xff ? 0xff : a.v + b.v)};
+}
+inline auto max(one a, one b) -> one { return {a.v > b.v ? a.v : b.v}; }
+inline auto eq(one a, one b) -> one {
+  return {static_cast<byte>(a.v == b.v ? 0xff : 0x00)};
+}
+inline auto shr1(one a) -> one { return {static_cast<byte>(a.v >> 1)}; }
+
+#if defined(__AVX2__)
+
+struct wide {
+  static constexpr std::size_t width = 32;
+
+  static auto load(const byte* at) -> wide {
+    const auto* from = reinterpret_cast<const __m256i*>(at);  // NOLINT
+    return {_mm256_loadu_si256(from)};
+  }
+  static auto splat(byte value) -> wide {
+    return {_mm256_set1_epi8(static_cast<char>(value))};
+  }
+  auto store(byte* at) const -> void {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(at), v);  // NOLINT
+  }
+
+  __m256i v;
+};
+
+inline auto operator+(wide a, wide b) -> wide {
+  return {_mm256_add_epi8(a.v, b.v)};
+}
+inline auto operator-(wide a, wide b) -> wide {
+  return {_mm256_sub_epi8(a.v, b.v)};
+}
+inline auto operator&(wide a, wide b) -> wide {
+  return {_mm256_and_si256(a.v, b.v)};
+}
+inline auto operator|(wide a, wide b) -> wide {
+  return {_mm256_or_si256(a.v, b.v)};
+}
+inline auto operator^(wide a, wide b) -> wide {
+  return {_mm256_xor_si256(a.v, b.v)};
+}
+inline auto adds(wide a, wide b) -> wide {
+  return {_mm256_adds_epu8(a.v, b.v)};
+}
+inline auto max(wide a, wide b) -> wide {
+  return {_mm256_max_epu8(a.v, b.v)};
+}
+inline auto eq(wide a, wide b) -> wide {
+  return {_mm256_cmpeq_epi8(a.v, b.v)};
+}
+// There is no byte shift: shift words and drop what came from the next byte.
+inline auto shr1(wide a) -> wide {
+  return {
+      _mm256_and_si256(_mm256_srli_epi16(a.v, 1), _mm256_set1_epi8(0x7f))};
+}
+
+#elif defined(__SSE2__)
+
+struct wide {
+  static constexpr std::size_t width = 16;
+
+  static auto load(const byte* at) -> wide {
+    const auto* from = reinterpret_cast<const __m128i*>(at);  // NOLINT
+    return {_mm_loadu_si128(from)};
+  }
+  static auto splat(byte value) -> wide {
+    return {_mm_set1_epi8(static_cast<char>(value))};
+  }
+  auto store(byte* at) const -> void {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(at), v);  // NOLINT
+  }
+
+  __m128i v;
+};
+
+inline auto operator+(wide a, wide b) -> wide {
+  return {_mm_add_epi8(a.v, b.v)};
+}
+inline auto operator-(wide a, wide b) -> wide {
+  return {_mm_sub_epi8(a.v, b.v)};
+}
+inline auto operator&(wide a, wide b) -> wide {
+  return {_mm_and_si128(a.v, b.v)};
+}
+inline auto operator|(wide a, wide b) -> wide {
+  return {_mm_or_si128(a.v, b.v)};
+}
+inline auto operator^(wide a, wide b) -> wide {
+  return {_mm_xor_si128(a.v, b.v)};
+}
+inline auto adds(wide a, wide b) -> wide { return {_mm_adds_epu8(a.v, b.v)}; }
+inline auto max(wide a, wide b) -> wide { return {_mm_max_epu8(a.v, b.v)}; }
+inline auto eq(wide a, wide b) -> wide { return {_mm_cmpeq_epi8(a.v, b.v)}; }
+// There is no byte shift: shift words and drop what came from the next byte.
+inline auto shr1(wide a) -> wide {
+  return {_mm_and_si128(_mm_srli_epi16(a.v, 1), _mm_set1_epi8(0x7f))};
+}
+
+#endif
+
+// Runs `kernel(V{}, i)` over lanes [0, N): on a vector type V at lane i for
+// as many whole vectors as fit, then on `one` for the rest.
+template <std::size_t N, typename F>
+inline auto each(F&& kernel) -> void {
+  std::size_t i = 0;
+#if CONSTEXPR_6502_LANES_WIDE
+  for (; i + wide::width <= N; i += wide::width) {
+    kernel(wide{}, i);
+  }
+#endif
+  for (; i < N; i++) {
+    kernel(one{}, i);
+  }
+}
+
+}  // namespace lanes
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef CONSTEXPR_6502_LOADER_H
+#define CONSTEXPR_6502_LOADER_H
+
+// Loading programs and memory images from files. Not part of core.h,
+// include "loader.h" to use it; it needs POSIX.
+//
+// Files are mapped rather than read, so loading copies each byte once,
+// straight into memory, and a ROM mapped with map_rom_image() is never
+// copied at all.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "bus.h"
+#include "common.h"
+#include "snapshot.h"
+
+// A file mapped read only into the address space.
+class mapped_file {
+ public:
+  explicit mapped_file(const std::string& path) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      auto error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), path);
+    }
+
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size != 0) {
+      auto* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        auto error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+      }
+      m_data = static_cast<const byte*>(data);
+    }
+
+    ::close(fd);
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file(mapped_file&&) = delete;
+  auto operator=(const mapped_file&) -> mapped_file& = delete;
+  auto operator=(mapped_file&&) -> mapped_file& = delete;
+
+  ~mapped_file() {
+    if (m_data != nullptr) {
+      ::munmap(const_cast<byte*>(m_data), m_size);  // NOLINT
+    }
+  }
+
+  [[nodiscard]] auto data() const -> const byte* { return m_data; }
+  [[nodiscard]] auto size() const -> std::size_t { return m_size; }
+
+ private:
+  const byte* m_data = nullptr;
+  std::size_t m_size = 0;
+};
+
+// A rom_image backed by the mapped file at `path`. Pages are only read in
+// from the file as the cpu touches them. The file is padded with zeros to
+// whole pages, which the mapping already provides: a 256 byte page never
+// straddles a page of the OS.
+inline auto map_rom_image(const std::string& path) -> rom_image {
+  auto file = std::make_shared<const mapped_file>(path);
+  auto size = file->size();
+
+  return {std::shared_ptr<const byte>(file, file->data()), size};
+}
+
+// Loads a raw binary at `origin`. That includes the files that
+// scripts/asm2arr.py names .o65: plain `xa` writes raw code, only `xa -R`
+// writes o65 objects.
+template <typename Cpu>
+auto load_raw(Cpu& cpu, const std::string& path, word origin) -> void {
+  mapped_file file(path);
+  cpu.load(origin, file.data(), file.size());
+}
+
+// Loads the text and data segments of an o65 object, as written by
+// `xa -R`, at the addresses it was assembled for. The object is not
+// relocated, and only 16 bit sizes are supported. Returns the text base,
+// where a program usually starts.
+template <typename Cpu>
+auto load_o65(Cpu& cpu, const std::string& path) -> word {
+  mapped_file file(path);
+  const auto* data = file.data();
+  auto size = file.size();
+  std::size_t at = 0;
+
+  auto need = [&](std::size_t count) {
+    if (size - at < count) {
+      throw std::runtime_error("load_o65: truncated " + path);
+    }
+  };
+  auto next16 = [&] {
+    need(2);
+    auto value = static_cast<word>(data[at + 1] << 8 | data[at]);
+    at += 2;
+    return value;
+  };
+
+  need(8);
+  if (data[0] != 0x01 || data[1] != 0x00 || data[2] != 'o' ||
+      data[3] != '6' || data[4] != '5') {
+    throw std::runtime_error("load_o65: not an o65 object " + path);
+  }
+  at = 6;
+  if ((next16() & 0x2000) != 0) {
+    throw std::runtime_error("load_o65: 32 bit object " + path);
+  }
+
+  auto tbase = next16();
+  auto tlen = next16();
+  auto dbase = next16();
+  auto dlen = next16();
+  for (int skipped = 0; skipped < 5; skipped++) {
+    next16();  // bss, zero page and stack, which need no loading
+  }
+
+  // Header options, each led by its length, up to a zero length.
+  for (need(1); data[at] != 0; need(1)) {
+    need(data[at]);
+    at += data[at];
+  }
+  at++;
+
+  need(tlen);
+  cpu.load(tbase, data + at, tlen);
+  at += tlen;
+
+  need(dlen);
+  cpu.load(dbase, data + at, dlen);
+
+  return tbase;
+}
+
+// Writes all 64K of the cpu's memory to `path`, for load_image().
+template <typename Cpu>
+auto save_image(const Cpu& cpu, const std::string& path) -> void {
+  std::array<byte, 0x10000> bytes{};
+  for (std::size_t addr = 0; addr < bytes.size(); addr++) {
+    bytes[addr] = cpu.read(static_cast<word>(addr));
+  }
+
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(
+      std::fopen(path.c_str(), "wb"), &std::fclose);
+  if (!file || std::fwrite(bytes.data(), 1, bytes.size(), file.get()) !=
+                   bytes.size()) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+}
+
+// Loads a 64K image written by save_image().
+template <typename Cpu>
+auto load_image(Cpu& cpu, const std::string& path) -> void {
+  mapped_file file(path);
+  if (file.size() != 0x10000) {
+    throw std::runtime_error("load_image: not a 64K image " + path);
+  }
+
+  cpu.load(0x0000, file.data(), file.size());
+}
+
+// Saves a snapshot of `cpu` to `path`, for load_state().
+template <typename Cpu>
+auto save_state(const Cpu& cpu, const std::string& path) -> void {
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(
+      std::fopen(path.c_str(), "wb"), &std::fclose);
+  bool written = static_cast<bool>(file);
+  if (written) {
+    snapshot::save(cpu, [&](const byte* data, std::size_t size) {
+      written = written && std::fwrite(data, 1, size, file.get()) == size;
+    });
+  }
+  if (!written || std::fflush(file.get()) != 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+}
+
+// Loads a snapshot written by save_state(), straight from the mapped file.
+template <typename Cpu>
+auto load_state(Cpu& cpu, const std::string& path) -> void {
+  mapped_file file(path);
+  load_state(cpu, file.data(), file.size());
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef CONSTEXPR_6502_MAPPER_H
+#define CONSTEXPR_6502_MAPPER_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bus.h"
+#include "common.h"
+
+// Bank switching for a paged_memory: N windows of 16 KB, each showing one
+// bank of ROM or RAM, and a page of registers selecting them. Register `i`,
+// at offset i of the register page, holds the bank of window `i`; banks
+// 0 to rom_banks() - 1 are the ROM image in 16 KB pieces and the rest RAM.
+//
+// Selecting a bank rewrites the window's entries in the page table, so
+// reads and writes in a window cost what they cost on any other RAM or ROM
+// page. Only register accesses reach the mapper. A switch counts as a remap
+// in paged_memory::mapping(), so a cpu drops the code it decoded before.
+//
+// A mapper drives the one paged_memory it was built with and owns its RAM
+// banks: copies of that memory share them, and keep switching through it.
+class window_mapper : public bus_device {
+ public:
+  static constexpr std::size_t bank_size = 0x4000;
+  static constexpr std::size_t bank_pages = bank_size / paged_memory::page_size;
+
+  // Maps a window at each page of `windows`, showing banks 0, 1, 2... in
+  // order, and the registers at page `registers`. `rom` is a whole number
+  // of banks.
+  window_mapper(paged_memory& memory, rom_image rom, std::size_t ram_banks,
+                std::vector<std::size_t> windows, std::size_t registers)
+      : m_memory(&memory),
+        m_rom(std::move(rom)),
+        m_ram(ram_banks * bank_size),
+        m_windows(std::move(windows)),
+        m_selected(m_windows.size()) {
+    if (m_rom.size() % bank_size != 0) {
+      throw std::invalid_argument("window_mapper: partial ROM bank");
+    }
+    if (banks() == 0 || m_windows.size() > paged_memory::page_size) {
+      throw std::invalid_argument("window_mapper: no banks or windows");
+    }
+
+    for (auto first : m_windows) {
+      if (first + bank_pages > paged_memory::pages ||
+          (registers >= first && registers < first + bank_pages)) {
+        throw std::invalid_argument("window_mapper: window out of place");
+      }
+    }
+
+    for (std::size_t window = 0; window < m_windows.size(); window++) {
+      select(window, window);
+    }
+    m_memory->map_device(registers, 1, *this);
+  }
+
+  // Reads the bank of a window, or 0xff past the last one.
+  auto read(word addr) -> byte override {
+    auto window = static_cast<std::size_t>(addr & 0xff);
+    return window < m_windows.size() ? static_cast<byte>(m_selected[window])
+                                     : 0xff;
+  }
+
+  // Selects a bank, modulo banks(). Writes past the last window are
+  // ignored.
+  auto write(word addr, byte data) -> void override {
+    auto window = static_cast<std::size_t>(addr & 0xff);
+    if (window < m_windows.size()) {
+      select(window, data);
+    }
+  }
+
+  auto select(std::size_t window, std::size_t bank) -> void {
+    bank %= banks();
+    m_selected[window] = bank;
+
+    auto first = m_windows[window];
+    if (bank < rom_banks()) {
+      m_memory->map_rom(first, bank_pages, m_rom.data() + bank * bank_size);
+    } else {
+      m_memory->map_ram(first, bank_pages,
+                        m_ram.data() + (bank - rom_banks()) * bank_size);
+    }
+  }
+
+  [[nodiscard]] auto bank(std::size_t window) const -> std::size_t {
+    return m_selected[window];
+  }
+
+  [[nodiscard]] auto rom_banks() const -> std::size_t {
+    return m_rom.size() / bank_size;
+  }
+
+  [[nodiscard]] auto banks() const -> std::size_t {
+    return rom_banks() + m_ram.size() / bank_size;
+  }
+
+ private:
+  paged_memory* m_memory;
+  rom_image m_rom;
+  std::vector<byte> m_ram;
+
+  // First page of each window, and the bank it shows.
+  std::vector<std::size_t> m_windows;
+  std::vector<std::size_t> m_selected;
+};
+
+#endif
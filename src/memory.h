@@ -0,0 +1,91 @@
+#ifndef CONSTEXPR_6502_MEMORY_H
+#define CONSTEXPR_6502_MEMORY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+
+// Memory models for basic_cpu6502. Each covers the whole 16 bit address
+// space through read() and write(), says through writable() which 256 byte
+// pages are plain RAM, read and written without side effects, and counts
+// in mapping() the changes to what an address reads, other than writes.
+
+// All 64K in one array, the model of cpu6502. The JIT reads `bytes`
+// directly.
+class flat_memory {
+ public:
+  [[nodiscard]] constexpr auto read(word addr) const -> byte {
+    return bytes[addr];
+  }
+
+  constexpr auto write(word addr, byte data) -> void { bytes[addr] = data; }
+
+  [[nodiscard]] static constexpr auto writable(std::size_t /*page*/) -> bool {
+    return true;
+  }
+
+  [[nodiscard]] static constexpr auto mapping() -> std::uint64_t { return 0; }
+
+  std::array<byte, 0x10000> bytes{};
+};
+
+// flat_memory that also keeps one bit per 256 byte page written, so that
+// restore() only copies back what changed. The bits are set by write() and
+// cleared by clean(); a copy keeps them.
+class tracked_memory {
+ public:
+  [[nodiscard]] constexpr auto read(word addr) const -> byte {
+    return bytes[addr];
+  }
+
+  constexpr auto write(word addr, byte data) -> void {
+    bytes[addr] = data;
+    dirty[addr >> 14] |= std::uint64_t{1} << (addr >> 8 & 63);
+  }
+
+  [[nodiscard]] static constexpr auto writable(std::size_t /*page*/) -> bool {
+    return true;
+  }
+
+  [[nodiscard]] static constexpr auto mapping() -> std::uint64_t { return 0; }
+
+  [[nodiscard]] constexpr auto is_dirty(std::size_t page) const -> bool {
+    return ((dirty[page / 64] >> (page % 64)) & 1) != 0;
+  }
+
+  // One bit per page written since the last clean().
+  [[nodiscard]] constexpr auto dirty_pages() const
+      -> const std::array<std::uint64_t, 4>& {
+    return dirty;
+  }
+
+  constexpr auto clean() -> void { dirty = {}; }
+
+  // Makes this memory equal to `baseline`, bits included, by copying the
+  // pages dirty in either. This is exact as long as the two only differ on
+  // those pages, as when one is a copy of the other or both were loaded the
+  // same way and then cleaned.
+  constexpr auto restore(const tracked_memory& baseline) -> void {
+    for (std::size_t i = 0; i < dirty.size(); i++) {
+      auto pages = dirty[i] | baseline.dirty[i];
+
+      for (std::size_t bit = 0; pages != 0; bit++, pages >>= 1) {
+        if ((pages & 1) != 0) {
+          auto first = (i * 64 + bit) * 0x100;
+          for (auto addr = first; addr < first + 0x100; addr++) {
+            bytes[addr] = baseline.bytes[addr];
+          }
+        }
+      }
+    }
+
+    dirty = baseline.dirty;
+  }
+
+  std::array<byte, 0x10000> bytes{};
+  std::array<std::uint64_t, 4> dirty{};
+};
+
+#endif
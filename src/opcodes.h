@@ -0,0 +1,272 @@
+#ifndef CONSTEXPR_6502_OPCODES_H
+#define CONSTEXPR_6502_OPCODES_H
+
+// The 6502 opcode table, in opcode order. Each row is expanded through
+// X(opcode, name, operate, addrmode, cycles), so the dispatch table, the
+// metadata table and the switch core are all generated from this single
+// list. `cycles` is the base cycle count, before the page crossing and
+// taken branch penalties.
+// Read-modify-write operations are instantiated on their addressing mode, so
+// the accumulator and memory forms are resolved at compile time.
+
+// clang-format off
+#define CONSTEXPR_6502_OPCODES(X) \
+  X(0x00, "BRK", BRK, IMM, 7) \
+  X(0x01, "ORA", ORA, IZX, 6) \
+  X(0x02, "HLT", HLT, IMP, 2) \
+  X(0x03, "???", NOP, IMP, 8) \
+  X(0x04, "???", NOP, IMP, 3) \
+  X(0x05, "ORA", ORA, ZP0, 3) \
+  X(0x06, "ASL", ASL<&_::ZP0>, ZP0, 5) \
+  X(0x07, "???", NOP, IMP, 5) \
+  X(0x08, "PHP", PHP, IMP, 3) \
+  X(0x09, "ORA", ORA, IMM, 2) \
+  X(0x0a, "ASL", ASL<&_::IMP>, IMP, 2) \
+  X(0x0b, "???", NOP, IMP, 2) \
+  X(0x0c, "???", NOP, IMP, 4) \
+  X(0x0d, "ORA", ORA, ABS, 4) \
+  X(0x0e, "ASL", ASL<&_::ABS>, ABS, 6) \
+  X(0x0f, "???", NOP, IMP, 6) \
+  X(0x10, "BPL", BPL, REL, 2) \
+  X(0x11, "ORA", ORA, IZY, 5) \
+  X(0x12, "???", NOP, IMP, 2) \
+  X(0x13, "???", NOP, IMP, 8) \
+  X(0x14, "???", NOP, IMP, 4) \
+  X(0x15, "ORA", ORA, ZPX, 4) \
+  X(0x16, "ASL", ASL<&_::ZPX>, ZPX, 6) \
+  X(0x17, "???", NOP, IMP, 6) \
+  X(0x18, "CLC", CLC, IMP, 2) \
+  X(0x19, "ORA", ORA, ABY, 4) \
+  X(0x1a, "???", NOP, IMP, 2) \
+  X(0x1b, "???", NOP, IMP, 7) \
+  X(0x1c, "???", NOP, IMP, 4) \
+  X(0x1d, "ORA", ORA, ABX, 4) \
+  X(0x1e, "ASL", ASL<&_::ABX>, ABX, 7) \
+  X(0x1f, "???", NOP, IMP, 7) \
+  X(0x20, "JSR", JSR, ABS, 6) \
+  X(0x21, "AND", AND, IZX, 6) \
+  X(0x22, "???", NOP, IMP, 2) \
+  X(0x23, "???", NOP, IMP, 8) \
+  X(0x24, "BIT", BIT, ZP0, 3) \
+  X(0x25, "AND", AND, ZP0, 3) \
+  X(0x26, "ROL", ROL<&_::ZP0>, ZP0, 5) \
+  X(0x27, "???", NOP, IMP, 5) \
+  X(0x28, "PLP", PLP, IMP, 4) \
+  X(0x29, "AND", AND, IMM, 2) \
+  X(0x2a, "ROL", ROL<&_::IMP>, IMP, 2) \
+  X(0x2b, "???", NOP, IMP, 2) \
+  X(0x2c, "BIT", BIT, ABS, 4) \
+  X(0x2d, "AND", AND, ABS, 4) \
+  X(0x2e, "ROL", ROL<&_::ABS>, ABS, 6) \
+  X(0x2f, "???", NOP, IMP, 6) \
+  X(0x30, "BMI", BMI, REL, 2) \
+  X(0x31, "AND", AND, IZY, 5) \
+  X(0x32, "???", NOP, IMP, 2) \
+  X(0x33, "???", NOP, IMP, 8) \
+  X(0x34, "???", NOP, IMP, 4) \
+  X(0x35, "AND", AND, ZPX, 4) \
+  X(0x36, "ROL", ROL<&_::ZPX>, ZPX, 6) \
+  X(0x37, "???", NOP, IMP, 6) \
+  X(0x38, "SEC", SEC, IMP, 2) \
+  X(0x39, "AND", AND, ABY, 4) \
+  X(0x3a, "???", NOP, IMP, 2) \
+  X(0x3b, "???", NOP, IMP, 7) \
+  X(0x3c, "???", NOP, IMP, 4) \
+  X(0x3d, "AND", AND, ABX, 4) \
+  X(0x3e, "ROL", ROL<&_::ABX>, ABX, 7) \
+  X(0x3f, "???", NOP, IMP, 7) \
+  X(0x40, "RTI", RTI, IMP, 6) \
+  X(0x41, "EOR", EOR, IZX, 6) \
+  X(0x42, "???", NOP, IMP, 2) \
+  X(0x43, "???", NOP, IMP, 8) \
+  X(0x44, "???", NOP, IMP, 3) \
+  X(0x45, "EOR", EOR, ZP0, 3) \
+  X(0x46, "LSR", LSR<&_::ZP0>, ZP0, 5) \
+  X(0x47, "???", NOP, IMP, 5) \
+  X(0x48, "PHA", PHA, IMP, 3) \
+  X(0x49, "EOR", EOR, IMM, 2) \
+  X(0x4a, "LSR", LSR<&_::IMP>, IMP, 2) \
+  X(0x4b, "???", NOP, IMP, 2) \
+  X(0x4c, "JMP", JMP, ABS, 3) \
+  X(0x4d, "EOR", EOR, ABS, 4) \
+  X(0x4e, "LSR", LSR<&_::ABS>, ABS, 6) \
+  X(0x4f, "???", NOP, IMP, 6) \
+  X(0x50, "BVC", BVC, REL, 2) \
+  X(0x51, "EOR", EOR, IZY, 5) \
+  X(0x52, "???", NOP, IMP, 2) \
+  X(0x53, "???", NOP, IMP, 8) \
+  X(0x54, "???", NOP, IMP, 4) \
+  X(0x55, "EOR", EOR, ZPX, 4) \
+  X(0x56, "LSR", LSR<&_::ZPX>, ZPX, 6) \
+  X(0x57, "???", NOP, IMP, 6) \
+  X(0x58, "CLI", CLI, IMP, 2) \
+  X(0x59, "EOR", EOR, ABY, 4) \
+  X(0x5a, "???", NOP, IMP, 2) \
+  X(0x5b, "???", NOP, IMP, 7) \
+  X(0x5c, "???", NOP, IMP, 4) \
+  X(0x5d, "EOR", EOR, ABX, 4) \
+  X(0x5e, "LSR", LSR<&_::ABX>, ABX, 7) \
+  X(0x5f, "???", NOP, IMP, 7) \
+  X(0x60, "RTS", RTS, IMP, 6) \
+  X(0x61, "ADC", ADC, IZX, 6) \
+  X(0x62, "???", NOP, IMP, 2) \
+  X(0x63, "???", NOP, IMP, 8) \
+  X(0x64, "???", NOP, IMP, 3) \
+  X(0x65, "ADC", ADC, ZP0, 3) \
+  X(0x66, "ROR", ROR<&_::ZP0>, ZP0, 5) \
+  X(0x67, "???", NOP, IMP, 5) \
+  X(0x68, "PLA", PLA, IMP, 4) \
+  X(0x69, "ADC", ADC, IMM, 2) \
+  X(0x6a, "ROR", ROR<&_::IMP>, IMP, 2) \
+  X(0x6b, "???", NOP, IMP, 2) \
+  X(0x6c, "JMP", JMP, IND, 5) \
+  X(0x6d, "ADC", ADC, ABS, 4) \
+  X(0x6e, "ROR", ROR<&_::ABS>, ABS, 6) \
+  X(0x6f, "???", NOP, IMP, 6) \
+  X(0x70, "BVS", BVS, REL, 2) \
+  X(0x71, "ADC", ADC, IZY, 5) \
+  X(0x72, "???", NOP, IMP, 2) \
+  X(0x73, "???", NOP, IMP, 8) \
+  X(0x74, "???", NOP, IMP, 4) \
+  X(0x75, "ADC", ADC, ZPX, 4) \
+  X(0x76, "ROR", ROR<&_::ZPX>, ZPX, 6) \
+  X(0x77, "???", NOP, IMP, 6) \
+  X(0x78, "SEI", SEI, IMP, 2) \
+  X(0x79, "ADC", ADC, ABY, 4) \
+  X(0x7a, "???", NOP, IMP, 2) \
+  X(0x7b, "???", NOP, IMP, 7) \
+  X(0x7c, "???", NOP, IMP, 4) \
+  X(0x7d, "ADC", ADC, ABX, 4) \
+  X(0x7e, "ROR", ROR<&_::ABX>, ABX, 7) \
+  X(0x7f, "???", NOP, IMP, 7) \
+  X(0x80, "???", NOP, IMP, 2) \
+  X(0x81, "STA", STA, IZX, 6) \
+  X(0x82, "???", NOP, IMP, 2) \
+  X(0x83, "???", NOP, IMP, 6) \
+  X(0x84, "STY", STY, ZP0, 3) \
+  X(0x85, "STA", STA, ZP0, 3) \
+  X(0x86, "STX", STX, ZP0, 3) \
+  X(0x87, "???", NOP, IMP, 3) \
+  X(0x88, "DEY", DEY, IMP, 2) \
+  X(0x89, "???", NOP, IMP, 2) \
+  X(0x8a, "TXA", TXA, IMP, 2) \
+  X(0x8b, "???", NOP, IMP, 2) \
+  X(0x8c, "STY", STY, ABS, 4) \
+  X(0x8d, "STA", STA, ABS, 4) \
+  X(0x8e, "STX", STX, ABS, 4) \
+  X(0x8f, "???", NOP, IMP, 4) \
+  X(0x90, "BCC", BCC, REL, 2) \
+  X(0x91, "STA", STA, IZY, 6) \
+  X(0x92, "???", NOP, IMP, 2) \
+  X(0x93, "???", NOP, IMP, 6) \
+  X(0x94, "STY", STY, ZPX, 4) \
+  X(0x95, "STA", STA, ZPX, 4) \
+  X(0x96, "STX", STX, ZPY, 4) \
+  X(0x97, "???", NOP, IMP, 4) \
+  X(0x98, "TYA", TYA, IMP, 2) \
+  X(0x99, "STA", STA, ABY, 5) \
+  X(0x9a, "TXS", TXS, IMP, 2) \
+  X(0x9b, "???", NOP, IMP, 5) \
+  X(0x9c, "???", NOP, IMP, 5) \
+  X(0x9d, "STA", STA, ABX, 5) \
+  X(0x9e, "???", NOP, IMP, 5) \
+  X(0x9f, "???", NOP, IMP, 5) \
+  X(0xa0, "LDY", LDY, IMM, 2) \
+  X(0xa1, "LDA", LDA, IZX, 6) \
+  X(0xa2, "LDX", LDX, IMM, 2) \
+  X(0xa3, "???", NOP, IMP, 6) \
+  X(0xa4, "LDY", LDY, ZP0, 3) \
+  X(0xa5, "LDA", LDA, ZP0, 3) \
+  X(0xa6, "LDX", LDX, ZP0, 3) \
+  X(0xa7, "???", NOP, IMP, 3) \
+  X(0xa8, "TAY", TAY, IMP, 2) \
+  X(0xa9, "LDA", LDA, IMM, 2) \
+  X(0xaa, "TAX", TAX, IMP, 2) \
+  X(0xab, "???", NOP, IMP, 2) \
+  X(0xac, "LDY", LDY, ABS, 4) \
+  X(0xad, "LDA", LDA, ABS, 4) \
+  X(0xae, "LDX", LDX, ABS, 4) \
+  X(0xaf, "???", NOP, IMP, 4) \
+  X(0xb0, "BCS", BCS, REL, 2) \
+  X(0xb1, "LDA", LDA, IZY, 5) \
+  X(0xb2, "???", NOP, IMP, 2) \
+  X(0xb3, "???", NOP, IMP, 5) \
+  X(0xb4, "LDY", LDY, ZPX, 4) \
+  X(0xb5, "LDA", LDA, ZPX, 4) \
+  X(0xb6, "LDX", LDX, ZPY, 4) \
+  X(0xb7, "???", NOP, IMP, 4) \
+  X(0xb8, "CLV", CLV, IMP, 2) \
+  X(0xb9, "LDA", LDA, ABY, 4) \
+  X(0xba, "TSX", TSX, IMP, 2) \
+  X(0xbb, "???", NOP, IMP, 4) \
+  X(0xbc, "LDY", LDY, ABX, 4) \
+  X(0xbd, "LDA", LDA, ABX, 4) \
+  X(0xbe, "LDX", LDX, ABY, 4) \
+  X(0xbf, "???", NOP, IMP, 4) \
+  X(0xc0, "CPY", CPY, IMM, 2) \
+  X(0xc1, "CMP", CMP, IZX, 6) \
+  X(0xc2, "???", NOP, IMP, 2) \
+  X(0xc3, "???", NOP, IMP, 8) \
+  X(0xc4, "CPY", CPY, ZP0, 3) \
+  X(0xc5, "CMP", CMP, ZP0, 3) \
+  X(0xc6, "DEC", DEC, ZP0, 5) \
+  X(0xc7, "???", NOP, IMP, 5) \
+  X(0xc8, "INY", INY, IMP, 2) \
+  X(0xc9, "CMP", CMP, IMM, 2) \
+  X(0xca, "DEX", DEX, IMP, 2) \
+  X(0xcb, "???", NOP, IMP, 2) \
+  X(0xcc, "CPY", CPY, ABS, 4) \
+  X(0xcd, "CMP", CMP, ABS, 4) \
+  X(0xce, "DEC", DEC, ABS, 6) \
+  X(0xcf, "???", NOP, IMP, 6) \
+  X(0xd0, "BNE", BNE, REL, 2) \
+  X(0xd1, "CMP", CMP, IZY, 5) \
+  X(0xd2, "???", NOP, IMP, 2) \
+  X(0xd3, "???", NOP, IMP, 8) \
+  X(0xd4, "???", NOP, IMP, 4) \
+  X(0xd5, "CMP", CMP, ZPX, 4) \
+  X(0xd6, "DEC", DEC, ZPX, 6) \
+  X(0xd7, "???", NOP, IMP, 6) \
+  X(0xd8, "CLD", CLD, IMP, 2) \
+  X(0xd9, "CMP", CMP, ABY, 4) \
+  X(0xda, "NOP", NOP, IMP, 2) \
+  X(0xdb, "???", NOP, IMP, 7) \
+  X(0xdc, "???", NOP, IMP, 4) \
+  X(0xdd, "CMP", CMP, ABX, 4) \
+  X(0xde, "DEC", DEC, ABX, 7) \
+  X(0xdf, "???", NOP, IMP, 7) \
+  X(0xe0, "CPX", CPX, IMM, 2) \
+  X(0xe1, "SBC", SBC, IZX, 6) \
+  X(0xe2, "???", NOP, IMP, 2) \
+  X(0xe3, "???", NOP, IMP, 8) \
+  X(0xe4, "CPX", CPX, ZP0, 3) \
+  X(0xe5, "SBC", SBC, ZP0, 3) \
+  X(0xe6, "INC", INC, ZP0, 5) \
+  X(0xe7, "???", NOP, IMP, 5) \
+  X(0xe8, "INX", INX, IMP, 2) \
+  X(0xe9, "SBC", SBC, IMM, 2) \
+  X(0xea, "NOP", NOP, IMP, 2) \
+  X(0xeb, "???", SBC, IMP, 2) \
+  X(0xec, "CPX", CPX, ABS, 4) \
+  X(0xed, "SBC", SBC, ABS, 4) \
+  X(0xee, "INC", INC, ABS, 6) \
+  X(0xef, "???", NOP, IMP, 6) \
+  X(0xf0, "BEQ", BEQ, REL, 2) \
+  X(0xf1, "SBC", SBC, IZY, 5) \
+  X(0xf2, "???", NOP, IMP, 2) \
+  X(0xf3, "???", NOP, IMP, 8) \
+  X(0xf4, "???", NOP, IMP, 4) \
+  X(0xf5, "SBC", SBC, ZPX, 4) \
+  X(0xf6, "INC", INC, ZPX, 6) \
+  X(0xf7, "???", NOP, IMP, 6) \
+  X(0xf8, "SED", SED, IMP, 2) \
+  X(0xf9, "SBC", SBC, ABY, 4) \
+  X(0xfa, "NOP", NOP, IMP, 2) \
+  X(0xfb, "???", NOP, IMP, 7) \
+  X(0xfc, "???", NOP, IMP, 4) \
+  X(0xfd, "SBC", SBC, ABX, 4) \
+  X(0xfe, "INC", INC, ABX, 7) \
+  X(0xff, "???", NOP, IMP, 7)
+// clang-format on
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef CONSTEXPR_6502_POLICY_H
+#define CONSTEXPR_6502_POLICY_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "common.h"
+
+// Check, trace and timing policies for basic_cpu6502. Each has a static
+// `enabled`, and the cpu only calls into a policy, or keeps the state it
+// feeds, when that is true, so a policy that is off costs nothing.
+//
+// The hooks run in the interpreter cores: exec_table(), exec_switch() and
+// exec_cached(). block_engine and jit_engine work on cpu6502 only.
+
+// CHECKS
+
+// No checks, what cpu6502 does.
+struct unchecked {
+  static constexpr bool enabled = false;
+
+  template <typename Cpu>
+  static constexpr auto check(const Cpu& /*cpu*/, word /*pc*/,
+                              byte /*opcode*/) -> void {}
+};
+
+// Throws on opcodes outside the documented set, the "???" rows of
+// opcodes.h, instead of running them as NOPs. In constant evaluation the
+// throw fails the compile.
+struct checked {
+  static constexpr bool enabled = true;
+
+  template <typename Cpu>
+  static constexpr auto check(const Cpu& /*cpu*/, word /*pc*/, byte opcode)
+      -> void {
+    if (Cpu::metadata[opcode].name == "???") {
+      throw std::runtime_error("checked: undocumented opcode");
+    }
+  }
+};
+
+// TRACING
+
+// State of the cpu before an instruction ran.
+struct trace_entry {
+  word pc;
+  byte opcode;
+  byte A;
+  byte X;
+  byte Y;
+  byte SP;
+  byte P;
+  std::uint64_t cycles;
+};
+
+// No trace, what cpu6502 does.
+//
+// A trace whose `undoes` is true also sees the old byte of every write(),
+// through wrote(), and lets the cpu step_back().
+struct no_trace {
+  static constexpr bool enabled = false;
+  static constexpr bool undoes = false;
+
+  template <typename Cpu>
+  constexpr auto record(const Cpu& /*cpu*/, word /*pc*/, byte /*opcode*/)
+      -> void {}
+};
+
+// Keeps the last `Size` instructions.
+template <std::size_t Size>
+class ring_trace {
+  static_assert(Size > 0, "An empty trace records nothing...");
+
+ public:
+  static constexpr bool enabled = true;
+  static constexpr bool undoes = false;
+
+  template <typename Cpu>
+  constexpr auto record(const Cpu& cpu, word pc, byte opcode) -> void {
+    m_entries[total % Size] = {pc,     opcode, cpu.A,         cpu.X,
+                               cpu.Y,  cpu.SP, cpu.getFlag(), cpu.cycles};
+    total++;
+  }
+
+  // Number of entries kept, at most Size.
+  [[nodiscard]] constexpr auto size() const -> std::size_t {
+    return total < Size ? static_cast<std::size_t>(total) : Size;
+  }
+
+  // Entries kept, oldest first.
+  [[nodiscard]] constexpr auto operator[](std::size_t index) const
+      -> const trace_entry& {
+    return m_entries[(total - size() + index) % Size];
+  }
+
+  [[nodiscard]] constexpr auto back() const -> const trace_entry& {
+    return (*this)[size() - 1];
+  }
+
+  // Instructions recorded so far, including those overwritten since.
+  std::uint64_t total = 0;
+
+ private:
+  std::array<trace_entry, Size> m_entries{};
+};
+
+// Undo information for the last `Size` instructions: the registers before
+// each one and the old byte of each of its writes, in a ring of `Writes`
+// bytes. An instruction can be undone while its state and all its writes
+// are still in the rings.
+//
+// Only write() is recorded. load() clears the history, restore() takes the
+// baseline's, and an interrupt is undone with the instruction before it.
+// Only writes to RAM, the pages the memory model calls writable(), are
+// undone: writes to devices and ROM stay.
+template <std::size_t Size, std::size_t Writes = 2 * Size>
+class undo_trace {
+  static_assert(Size > 0 && Writes > 0, "An empty trace undoes nothing...");
+
+ public:
+  static constexpr bool enabled = true;
+  static constexpr bool undoes = true;
+
+  template <typename Cpu>
+  constexpr auto record(const Cpu& cpu, word pc, byte opcode) -> void {
+    m_entries[total % Size] = {
+        {pc, opcode, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.getFlag(), cpu.cycles},
+        m_writes};
+    total++;
+    if (total > Size) {
+      m_oldest = std::max<std::uint64_t>(m_oldest, total - Size);
+    }
+  }
+
+  constexpr auto wrote(word addr, byte old) -> void {
+    m_written[m_writes % Writes] = {addr, old};
+    m_writes++;
+    if (m_writes > Writes) {
+      m_oldest_write =
+          std::max<std::uint64_t>(m_oldest_write, m_writes - Writes);
+    }
+  }
+
+  // Number of instructions that can be undone. Writes only grow with each
+  // instruction, so those whose writes are all kept are the newest ones.
+  [[nodiscard]] constexpr auto size() const -> std::size_t {
+    auto low = std::uint64_t{0};
+    auto high = total - m_oldest;
+    while (low < high) {
+      auto middle = high - (high - low) / 2;
+      if (undoable(total - middle)) {
+        low = middle;
+      } else {
+        high = middle - 1;
+      }
+    }
+    return static_cast<std::size_t>(low);
+  }
+
+  // Puts `cpu` back to before the last `count` instructions, or as many as
+  // can be undone. Returns how many were.
+  template <typename Cpu>
+  constexpr auto undo(Cpu& cpu, std::size_t count) -> std::size_t {
+    for (std::size_t i = 0; i < count; i++) {
+      if (total == m_oldest || !undoable(total - 1)) {
+        return i;
+      }
+
+      const auto& entry = m_entries[(total - 1) % Size];
+      for (; m_writes > entry.first_write; m_writes--) {
+        const auto& written = m_written[(m_writes - 1) % Writes];
+        cpu.memory.write(written.addr, written.old);
+      }
+
+      const auto& state = entry.state;
+      cpu.PC = state.pc;
+      cpu.A = state.A;
+      cpu.X = state.X;
+      cpu.Y = state.Y;
+      cpu.SP = state.SP;
+      cpu.setFlag(state.P);
+      cpu.cycles = state.cycles;
+      total--;
+    }
+
+    return count;
+  }
+
+  // Forgets everything recorded so far, nothing before can be undone.
+  constexpr auto clear() -> void {
+    m_oldest = total;
+    m_oldest_write = m_writes;
+  }
+
+  // Instructions recorded so far, less those undone.
+  std::uint64_t total = 0;
+
+ private:
+  struct entry {
+    trace_entry state;
+    std::uint64_t first_write;
+  };
+
+  struct write_entry {
+    word addr;
+    byte old;
+  };
+
+  [[nodiscard]] constexpr auto undoable(std::uint64_t index) const -> bool {
+    return m_entries[index % Size].first_write >= m_oldest_write;
+  }
+
+  std::array<entry, Size> m_entries{};
+  std::array<write_entry, Writes> m_written{};
+  std::uint64_t m_writes = 0;
+
+  // The oldest instruction and write still in the rings, the others were
+  // overwritten.
+  std::uint64_t m_oldest = 0;
+  std::uint64_t m_oldest_write = 0;
+};
+
+// TIMING
+
+// Counts cycles in cpu.cycles, what cpu6502 does.
+struct cycle_timing {
+  static constexpr bool enabled = true;
+};
+
+// Leaves cpu.cycles at zero. exec_cycles() is unavailable.
+struct no_timing {
+  static constexpr bool enabled = false;
+};
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef CONSTEXPR_6502_REPLAY_H
+#define CONSTEXPR_6502_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "bus.h"
+#include "common.h"
+
+// Recording and replaying what a run takes from outside the cpu: device
+// reads and interrupts. Everything else a cpu does follows from its state,
+// so replaying those inputs at the same points reproduces a run exactly,
+// without the devices and at the speed of a run without tracing.
+//
+// Inputs are stamped with the cpu's cycle count, which rises by at least 2
+// with every instruction: the cpu must count cycles.
+
+// A device read, or an interrupt taken before the instruction at `stamp`.
+struct input_event {
+  enum class kind : byte { read, irq, nmi };
+
+  std::uint64_t stamp = 0;
+  kind what = kind::read;
+  word addr = 0x0000;
+  byte data = 0x00;
+};
+
+// Events in the order they happened, append only. Each takes a kind byte
+// and the stamp as the distance to the last one in 7 bit groups, lowest
+// first, with the top bit set on all but the last; reads add their address
+// and data, 3 bytes. A read in a polling loop takes 5 bytes.
+//
+// `bytes` is all there is to save and load, for a file or a mapping.
+class input_log {
+ public:
+  auto append(const input_event& event) -> void {
+    bytes.push_back(static_cast<byte>(event.what));
+    for (auto delta = event.stamp - m_last;; delta >>= 7) {
+      if (delta < 0x80) {
+        bytes.push_back(static_cast<byte>(delta));
+        break;
+      }
+      bytes.push_back(static_cast<byte>(delta | 0x80));
+    }
+    m_last = event.stamp;
+
+    if (event.what == input_event::kind::read) {
+      bytes.push_back(static_cast<byte>(event.addr));
+      bytes.push_back(static_cast<byte>(event.addr >> 8));
+      bytes.push_back(event.data);
+    }
+  }
+
+  std::vector<byte> bytes;
+
+ private:
+  std::uint64_t m_last = 0;
+};
+
+// Reads the events of a log back, from any bytes written by input_log.
+class input_reader {
+ public:
+  input_reader(const byte* data, std::size_t size)
+      : m_data(data), m_size(size) {
+    advance();
+  }
+
+  explicit input_reader(const input_log& log)
+      : input_reader(log.bytes.data(), log.bytes.size()) {}
+
+  [[nodiscard]] auto done() const -> bool { return !m_has_next; }
+
+  [[nodiscard]] auto peek() const -> const input_event& { return m_next; }
+
+  auto next() -> input_event {
+    auto event = m_next;
+    advance();
+    return event;
+  }
+
+ private:
+  auto take() -> byte {
+    if (m_at == m_size) {
+      throw std::runtime_error("input_reader: truncated log");
+    }
+    return m_data[m_at++];
+  }
+
+  auto advance() -> void {
+    m_has_next = m_at < m_size;
+    if (!m_has_next) {
+      return;
+    }
+
+    auto what = take();
+    if (what > static_cast<byte>(input_event::kind::nmi)) {
+      throw std::runtime_error("input_reader: not an input log");
+    }
+    m_next.what = static_cast<input_event::kind>(what);
+
+    std::uint64_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+      auto group = take();
+      if (shift > 63) {
+        throw std::runtime_error("input_reader: not an input log");
+      }
+      delta |= static_cast<std::uint64_t>(group & 0x7f) << shift;
+      if ((group & 0x80) == 0) {
+        break;
+      }
+    }
+    m_next.stamp += delta;
+
+    if (m_next.what == input_event::kind::read) {
+      auto low = take();
+      m_next.addr = static_cast<word>(take() << 8 | low);
+      m_next.data = take();
+    } else {
+      m_next.addr = 0x0000;
+      m_next.data = 0x00;
+    }
+  }
+
+  const byte* m_data;
+  std::size_t m_size;
+  std::size_t m_at = 0;
+
+  input_event m_next;
+  bool m_has_next = false;
+};
+
+// Records the inputs of a run into `log`. Map the devices returned by
+// wrap() in place of the real ones, and raise interrupts through irq() and
+// nmi() rather than on the cpu.
+class input_recorder {
+ public:
+  // `clock` is the cycle count of the cpu being recorded, cpu.cycles.
+  explicit input_recorder(const std::uint64_t& clock) : m_clock(&clock) {}
+
+  // A device that reads and writes through `device`, logging every read.
+  // It lives as long as this recorder.
+  auto wrap(bus_device& device) -> bus_device& {
+    m_devices.push_back(std::make_unique<recording>(*this, device));
+    return *m_devices.back();
+  }
+
+  template <typename Cpu>
+  auto irq(Cpu& cpu) -> bool {
+    auto stamp = cpu.cycles;
+    if (!cpu.irq()) {
+      return false;
+    }
+
+    log.append({stamp, input_event::kind::irq});
+    return true;
+  }
+
+  template <typename Cpu>
+  auto nmi(Cpu& cpu) -> void {
+    log.append({cpu.cycles, input_event::kind::nmi});
+    cpu.nmi();
+  }
+
+  input_log log;
+
+ private:
+  class recording : public bus_device {
+   public:
+    recording(input_recorder& recorder, bus_device& device)
+        : m_recorder(&recorder), m_device(&device) {}
+
+    auto read(word addr) -> byte override {
+      auto data = m_device->read(addr);
+      m_recorder->log.append(
+          {*m_recorder->m_clock, input_event::kind::read, addr, data});
+      return data;
+    }
+
+    auto write(word addr, byte data) -> void override {
+      m_device->write(addr, data);
+    }
+
+   private:
+    input_recorder* m_recorder;
+    bus_device* m_device;
+  };
+
+  const std::uint64_t* m_clock;
+  std::vector<std::unique_ptr<recording>> m_devices;
+};
+
+// Replays a recorded run. The replayer is itself the device standing in
+// for every recorded one, mapped where they were, and exec() raises the
+// recorded interrupts before the instructions they came before. Throws
+// runtime_error as soon as the run asks for an input other than the next
+// one logged.
+class input_replayer : public bus_device {
+ public:
+  input_replayer(const byte* data, std::size_t size,
+                 const std::uint64_t& clock)
+      : m_events(data, size), m_clock(&clock) {}
+
+  input_replayer(const input_log& log, const std::uint64_t& clock)
+      : input_replayer(log.bytes.data(), log.bytes.size(), clock) {}
+
+  // Serves the next logged read, if it was of `addr` at this cycle.
+  auto read(word addr) -> byte override {
+    if (m_events.done() ||
+        m_events.peek().what != input_event::kind::read ||
+        m_events.peek().addr != addr || m_events.peek().stamp != *m_clock) {
+      throw std::runtime_error("input_replayer: run diverged from log");
+    }
+    return m_events.next().data;
+  }
+
+  // Writes to devices are outputs, left out of the replay.
+  auto write(word /*addr*/, byte /*data*/) -> void override {}
+
+  // Raises the interrupts logged at this cycle, then runs one instruction.
+  template <typename Cpu>
+  auto exec(Cpu& cpu) -> void {
+    while (!m_events.done() && m_events.peek().stamp <= cpu.cycles &&
+           m_events.peek().what != input_event::kind::read) {
+      if (m_events.peek().stamp != cpu.cycles) {
+        throw std::runtime_error("input_replayer: run diverged from log");
+      }
+      if (m_events.next().what == input_event::kind::irq) {
+        if (!cpu.irq()) {
+          throw std::runtime_error("input_replayer: run diverged from log");
+        }
+      } else {
+        cpu.nmi();
+      }
+    }
+
+    cpu.exec();
+  }
+
+  template <typename Cpu>
+  auto exec_n(Cpu& cpu, int value = 1) -> void {
+    for (int i = 0; i < value; i++) {
+      exec(cpu);
+    }
+  }
+
+  // Whether every logged input has been replayed.
+  [[nodiscard]] auto done() const -> bool { return m_events.done(); }
+
+ private:
+  input_reader m_events;
+  const std::uint64_t* m_clock;
+};
+
+#endif
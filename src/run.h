@@ -0,0 +1,97 @@
+#ifndef CONSTEXPR_6502_RUN_H
+#define CONSTEXPR_6502_RUN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "common.h"
+#include "cpu.h"
+
+// Runs a program in the constant evaluator and keeps only the parts of the
+// final state asked for, so a precomputed result costs its own size in the
+// binary rather than a whole cpu6502.
+//
+//   constexpr std::array<byte, 5> program = {0xa9, 0x2a, 0x85, 0x10, 0x02};
+//   constexpr auto result =
+//       run_constexpr<program, 0x1000, registers, memory_range<0x10, 1>>();
+//   static_assert(std::get<0>(result).A == 0x2a);
+//   static_assert(std::get<1>(result)[0] == 0x2a);
+
+// The registers and flags, as getFlag() packs them.
+struct registers {
+  byte A;
+  byte X;
+  byte Y;
+  byte SP;
+  byte P;
+  word PC;
+  std::uint64_t cycles;
+
+  template <typename Cpu>
+  static constexpr auto extract(const Cpu& cpu) -> registers {
+    return {cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.getFlag(), cpu.PC, cpu.cycles};
+  }
+
+  // The reverse of extract().
+  template <typename Cpu>
+  constexpr auto apply(Cpu& cpu) const -> void {
+    cpu.A = A;
+    cpu.X = X;
+    cpu.Y = Y;
+    cpu.SP = SP;
+    cpu.setFlag(P);
+    cpu.PC = PC;
+    cpu.cycles = cycles;
+  }
+};
+
+// `Size` bytes of memory starting at `Address`.
+template <word Address, std::size_t Size>
+struct memory_range {
+  static_assert(Address + Size <= 0x10000, "Range past the end of memory...");
+
+  static constexpr word address = Address;
+
+  std::array<byte, Size> bytes;
+
+  [[nodiscard]] constexpr auto operator[](std::size_t offset) const -> byte {
+    return bytes[offset];
+  }
+
+  // Little endian word at `offset`.
+  [[nodiscard]] constexpr auto read16(std::size_t offset) const -> word {
+    return static_cast<word>(bytes[offset + 1] << 8 | bytes[offset]);
+  }
+
+  template <typename Cpu>
+  static constexpr auto extract(const Cpu& cpu) -> memory_range {
+    memory_range range{};
+    for (std::size_t i = 0; i < Size; i++) {
+      range.bytes[i] = cpu.read(static_cast<word>(Address + i));
+    }
+    return range;
+  }
+};
+
+// Loads `Program`, any contiguous range of bytes with static storage, at
+// `Origin` and runs it from there up to its first HLT, stepping over it like
+// exec_until_hlt(). Returns one value per `Extract`, each of which is a type
+// with a static extract(cpu), like registers and memory_range.
+template <const auto& Program, word Origin, typename... Extract>
+constexpr auto run_constexpr() -> std::tuple<Extract...> {
+  cpu6502 cpu;
+
+  auto addr = Origin;
+  for (byte data : Program) {
+    cpu.write(addr++, data);
+  }
+
+  cpu.PC = Origin;
+  cpu.exec_until_hlt();
+
+  return {Extract::extract(cpu)...};
+}
+
+#endif
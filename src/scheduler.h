@@ -0,0 +1,154 @@
+#ifndef CONSTEXPR_6502_SCHEDULER_H
+#define CONSTEXPR_6502_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+// Cooperative scheduling of the parts of a board, cpus and devices, on one
+// clock in cycles. Each part is a task that runs for a while when resumed
+// and says when to resume it next; the scheduler resumes them in that
+// order, on the calling thread.
+//
+// A task keeps whatever it needs to carry on in its own members, so every
+// resume is a plain virtual call, without a thread or a stack to switch.
+
+// A part of the board. resume() runs it from time `now` and returns the time
+// to resume it at, `now` or later, or scheduler::done to drop it.
+class scheduled {
+ public:
+  scheduled() = default;
+  scheduled(const scheduled&) = delete;
+  scheduled(scheduled&&) = delete;
+  auto operator=(const scheduled&) -> scheduled& = delete;
+  auto operator=(scheduled&&) -> scheduled& = delete;
+  virtual ~scheduled() = default;
+
+  virtual auto resume(std::uint64_t now) -> std::uint64_t = 0;
+};
+
+class scheduler {
+ public:
+  static constexpr std::uint64_t done = UINT64_MAX;
+
+  // Schedules `task`, which must outlive the scheduler or be done, at `at`.
+  auto add(scheduled& task, std::uint64_t at = 0) -> void {
+    m_queue.push({at, m_added++, &task});
+  }
+
+  // Schedules a callable taking the time and returning the next one, kept
+  // by the scheduler.
+  template <typename F, typename = std::enable_if_t<
+                            !std::is_base_of_v<scheduled, std::decay_t<F>>>>
+  auto add(F func, std::uint64_t at = 0) -> void {
+    m_owned.push_back(std::make_unique<function_task<F>>(std::move(func)));
+    add(*m_owned.back(), at);
+  }
+
+  // Resumes tasks, earliest first and in the order they were added when
+  // due together, until the next one is due at `end` or later.
+  auto run_until(std::uint64_t end) -> void {
+    while (!m_queue.empty() && m_queue.top().at < end) {
+      auto next = m_queue.top();
+      m_queue.pop();
+
+      now = next.at;
+      auto at = next.task->resume(now);
+      resumes++;
+
+      if (at < now) {
+        throw std::runtime_error("scheduler: task resumed in the past");
+      }
+      if (at != done) {
+        m_queue.push({at, next.order, next.task});
+      }
+    }
+  }
+
+  [[nodiscard]] auto empty() const -> bool { return m_queue.empty(); }
+
+  // Time of the task resumed last.
+  std::uint64_t now = 0;
+
+  // Tasks resumed so far.
+  std::uint64_t resumes = 0;
+
+ private:
+  struct entry {
+    std::uint64_t at;
+    std::uint64_t order;
+    scheduled* task;
+
+    auto operator>(const entry& other) const -> bool {
+      return at != other.at ? at > other.at : order > other.order;
+    }
+  };
+
+  template <typename F>
+  class function_task : public scheduled {
+   public:
+    explicit function_task(F func) : m_func(std::move(func)) {}
+
+    auto resume(std::uint64_t now) -> std::uint64_t override {
+      return m_func(now);
+    }
+
+   private:
+    F m_func;
+  };
+
+  std::priority_queue<entry, std::vector<entry>, std::greater<>> m_queue;
+  std::vector<std::unique_ptr<scheduled>> m_owned;
+  std::uint64_t m_added = 0;
+};
+
+// A cpu on the board clock: each resume runs it for a quantum of cycles, or
+// of instructions, and resumes it again at its time, cpu.cycles plus the
+// time it spent waiting for the others. cpu.cycles keeps counting the
+// cycles the cpu ran, whatever the scheduler does.
+template <typename Cpu>
+class cpu_task : public scheduled {
+ public:
+  enum class unit { cycles, instructions };
+
+  cpu_task(Cpu& cpu, std::uint64_t quantum, unit by = unit::cycles)
+      : m_cpu(&cpu), m_quantum(quantum), m_by(by) {
+    if (quantum == 0) {
+      throw std::invalid_argument("cpu_task: empty quantum");
+    }
+  }
+
+  auto resume(std::uint64_t now) -> std::uint64_t override {
+    if (time() < now) {
+      m_waited += now - time();  // waited for the others since it last ran
+    }
+
+    if (m_by == unit::cycles) {
+      m_cpu->exec_cycles(m_quantum);
+    } else {
+      m_cpu->exec_n(static_cast<int>(m_quantum));
+    }
+    return time();
+  }
+
+  // The cpu's time on the board clock.
+  [[nodiscard]] auto time() const -> std::uint64_t {
+    return m_cpu->cycles + m_waited;
+  }
+
+ private:
+  Cpu* m_cpu;
+  std::uint64_t m_quantum;
+  unit m_by;
+  std::uint64_t m_waited = 0;
+};
+
+#endif
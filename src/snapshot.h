@@ -0,0 +1,231 @@
+#ifndef CONSTEXPR_6502_SNAPSHOT_H
+#define CONSTEXPR_6502_SNAPSHOT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+#include "memory.h"
+
+// A saved cpu: registers, packed flags, cycles and memory, in a versioned
+// little endian format.
+//
+//   magic "6502", version (2 bytes), header size (2 bytes)
+//   A, X, Y, SP, P packed as by getFlag(), PC (2 bytes), cycles (8 bytes)
+//   a bitmap of the 256 pages, bit set for a page that is not all zeros
+//   those pages, 256 bytes each, lowest first
+//
+// Readers skip header fields past the ones they know, so a later version
+// can add some and still be read by this one; a change to anything else
+// needs a new magic. The decode table is static and the decode cache and
+// trace are not part of the state: neither is saved.
+//
+// Only RAM is saved and loaded, the pages the memory model calls
+// writable(). On a paged_memory, ROM and device pages are saved as zeros,
+// without reading the devices, and loading leaves them, their mapping and
+// the devices behind them as they are.
+namespace snapshot {
+
+inline constexpr std::array<byte, 4> magic = {'6', '5', '0', '2'};
+inline constexpr std::uint16_t version = 1;
+
+// Registers and flags, from A to the end of cycles.
+inline constexpr std::size_t registers_size = 15;
+inline constexpr std::size_t header_size = 8 + registers_size;
+
+inline constexpr std::size_t page_size = 0x100;
+inline constexpr std::size_t pages = 0x100;
+
+// Memory with all 64K in one array, which save() reads in place.
+template <typename Memory>
+inline constexpr bool is_contiguous = std::is_same_v<Memory, flat_memory> ||
+                                      std::is_same_v<Memory, tracked_memory>;
+
+inline auto is_zero(const byte* data) -> bool {
+  std::uint64_t any = 0;
+  for (std::size_t i = 0; i < page_size; i += sizeof(any)) {
+    std::uint64_t chunk = 0;
+    std::memcpy(&chunk, data + i, sizeof(chunk));
+    any |= chunk;
+  }
+  return any == 0;
+}
+
+// Writes the snapshot of `cpu` through `put(const byte*, std::size_t)`.
+template <typename Cpu, typename Put>
+auto save(const Cpu& cpu, Put&& put) -> void {
+  std::array<byte, header_size> header{};
+  std::memcpy(header.data(), magic.data(), magic.size());
+  header[4] = static_cast<byte>(version);
+  header[5] = static_cast<byte>(version >> 8);
+  header[6] = static_cast<byte>(header_size);
+  header[7] = static_cast<byte>(header_size >> 8);
+
+  auto* at = &header[8];
+  *at++ = cpu.A;
+  *at++ = cpu.X;
+  *at++ = cpu.Y;
+  *at++ = cpu.SP;
+  *at++ = cpu.getFlag();
+  *at++ = static_cast<byte>(cpu.PC);
+  *at++ = static_cast<byte>(cpu.PC >> 8);
+  for (int shift = 0; shift < 64; shift += 8) {
+    *at++ = static_cast<byte>(cpu.cycles >> shift);
+  }
+  put(header.data(), header.size());
+
+  // Other memories are read into a copy first, through read(), RAM only.
+  using memory_type = std::remove_cv_t<decltype(cpu.memory)>;
+  std::vector<byte> copy;
+  const byte* bytes = nullptr;
+  if constexpr (is_contiguous<memory_type>) {
+    bytes = cpu.memory.bytes.data();
+  } else {
+    copy.resize(pages * page_size);
+    for (std::size_t page = 0; page < pages; page++) {
+      if (!cpu.memory.writable(page)) {
+        continue;
+      }
+      for (auto addr = page * page_size; addr < (page + 1) * page_size;
+           addr++) {
+        copy[addr] = cpu.read(static_cast<word>(addr));
+      }
+    }
+    bytes = copy.data();
+  }
+
+  std::array<byte, pages / 8> present{};
+  for (std::size_t page = 0; page < pages; page++) {
+    if (!is_zero(&bytes[page * page_size])) {
+      present[page / 8] |= static_cast<byte>(1U << (page % 8));
+    }
+  }
+  put(present.data(), present.size());
+
+  for (std::size_t page = 0; page < pages; page++) {
+    if ((present[page / 8] & (1U << (page % 8))) != 0) {
+      put(&bytes[page * page_size], page_size);
+    }
+  }
+}
+
+// Reads a snapshot into `cpu` through `get(byte*, std::size_t)`, which
+// returns false when it runs out of input. RAM pages go through the cpu's
+// load(), those left out as zeros included. Throws runtime_error for
+// anything that is not a snapshot this version can read; `cpu` is left
+// untouched when the header is bad, and partly loaded when the pages are
+// truncated.
+template <typename Cpu, typename Get>
+auto load(Cpu& cpu, Get&& get) -> void {
+  std::array<byte, header_size> header{};
+  if (!get(header.data(), 8) ||
+      std::memcmp(header.data(), magic.data(), magic.size()) != 0) {
+    throw std::runtime_error("load_state: not a snapshot");
+  }
+
+  auto saved_version = static_cast<std::uint16_t>(header[5] << 8 | header[4]);
+  auto saved_size = static_cast<std::size_t>(header[7] << 8 | header[6]);
+  if (saved_version == 0 || saved_size < header_size) {
+    throw std::runtime_error("load_state: unsupported snapshot version");
+  }
+  if (!get(&header[8], registers_size)) {
+    throw std::runtime_error("load_state: truncated snapshot");
+  }
+  for (auto extra = saved_size - header_size; extra > 0; extra--) {
+    byte skipped = 0;
+    if (!get(&skipped, 1)) {
+      throw std::runtime_error("load_state: truncated snapshot");
+    }
+  }
+
+  std::array<byte, pages / 8> present{};
+  if (!get(present.data(), present.size())) {
+    throw std::runtime_error("load_state: truncated snapshot");
+  }
+
+  std::array<byte, page_size> data{};
+  for (std::size_t page = 0; page < pages; page++) {
+    if ((present[page / 8] & (1U << (page % 8))) != 0) {
+      if (!get(data.data(), page_size)) {
+        throw std::runtime_error("load_state: truncated snapshot");
+      }
+    } else {
+      data.fill(0x00);
+    }
+    if (cpu.memory.writable(page)) {
+      cpu.load(static_cast<word>(page * page_size), data.data(), page_size);
+    }
+  }
+
+  const auto* at = &header[8];
+  cpu.A = *at++;
+  cpu.X = *at++;
+  cpu.Y = *at++;
+  cpu.SP = *at++;
+  cpu.setFlag(*at++);
+  cpu.PC = static_cast<word>(at[1] << 8 | at[0]);
+  at += 2;
+  cpu.cycles = 0;
+  for (int shift = 0; shift < 64; shift += 8) {
+    cpu.cycles |= static_cast<std::uint64_t>(*at++) << shift;
+  }
+}
+
+}  // namespace snapshot
+
+// Saves `cpu` to a stream opened in binary mode.
+template <typename Cpu>
+auto save_state(const Cpu& cpu, std::ostream& out) -> void {
+  snapshot::save(cpu, [&](const byte* data, std::size_t size) {
+    out.write(reinterpret_cast<const char*>(data),  // NOLINT
+              static_cast<std::streamsize>(size));
+  });
+  if (!out) {
+    throw std::runtime_error("save_state: write failed");
+  }
+}
+
+// Saves `cpu` to a buffer.
+template <typename Cpu>
+auto save_state(const Cpu& cpu) -> std::vector<byte> {
+  std::vector<byte> out;
+  out.reserve(snapshot::header_size + snapshot::pages / 8 +
+              snapshot::pages * snapshot::page_size);
+  snapshot::save(cpu, [&](const byte* data, std::size_t size) {
+    out.insert(out.end(), data, data + size);
+  });
+  return out;
+}
+
+template <typename Cpu>
+auto load_state(Cpu& cpu, std::istream& in) -> void {
+  snapshot::load(cpu, [&](byte* data, std::size_t size) {
+    in.read(reinterpret_cast<char*>(data),  // NOLINT
+            static_cast<std::streamsize>(size));
+    return static_cast<std::size_t>(in.gcount()) == size;
+  });
+}
+
+// Loads a snapshot from memory, such as a buffer from save_state() or a
+// mapped file.
+template <typename Cpu>
+auto load_state(Cpu& cpu, const byte* data, std::size_t size) -> void {
+  std::size_t at = 0;
+  snapshot::load(cpu, [&](byte* out, std::size_t count) {
+    if (size - at < count) {
+      return false;
+    }
+    std::memcpy(out, data + at, count);
+    at += count;
+    return true;
+  });
+}
+
+#endif
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "core.h"
+
+namespace {
+
+// A loop over every lockstep kind the bank knows, different on each lane
+// only through the registers it starts with:
+//   loop: TXA; ASL A; ADC #$1d; EOR $10; STA $10; ROR A; SBC $10
+//         AND #$7f; ORA $0f; LSR A; ROL A; CMP #$40; STA $0200,X
+//         LDY $10; STY $11; INX; DEY; DEY; TAY; CPY #$80; BCC skip
+//         SEC
+//   skip: CLC; CPX #$00; BNE loop
+//         HLT
+const std::vector<byte> mixer = {
+    0x8a, 0x0a, 0x69, 0x1d, 0x45, 0x10, 0x85, 0x10, 0x6a, 0xe5,
+    0x10, 0x29, 0x7f, 0x05, 0x0f, 0x4a, 0x2a, 0xc9, 0x40, 0x9d,
+    0x00, 0x02, 0xa4, 0x10, 0x84, 0x11, 0xe8, 0x88, 0x88, 0xa8,
+    0xc0, 0x80, 0x90, 0x01, 0x38, 0x18, 0xe0, 0x00, 0xd0, 0xd8,
+    0x02,
+};
+
+template <std::size_t N>
+auto load(cpu6502_bank<N>& bank, std::vector<std::unique_ptr<cpu6502>>& refs)
+    -> void {
+  for (std::size_t i = 0; i < N; i++) {
+    refs.push_back(std::make_unique<cpu6502>());
+    for (auto* cpu : {&bank.lane(i), refs.back().get()}) {
+      cpu->load(0x1000, mixer.data(), mixer.size());
+      cpu->PC = 0x1000;
+      cpu->X = static_cast<byte>(i * 37);
+      cpu->A = static_cast<byte>(i * 11);
+      cpu->write(0x0f, static_cast<byte>(i));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(Bank, RunsLikeScalar) {
+  auto bank = std::make_unique<cpu6502_bank<8>>();
+  std::vector<std::unique_ptr<cpu6502>> refs;
+  load(*bank, refs);
+
+  bank->exec_until_hlt();
+  for (auto& ref : refs) {
+    ref->exec_until_hlt();
+  }
+
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    EXPECT_EQ(bank->cycles[i], refs[i]->cycles) << "lane " << i;
+    EXPECT_TRUE(same_state(bank->lane(i), *refs[i])) << "lane " << i;
+  }
+  EXPECT_GT(bank->lockstep_steps, 0U);
+  EXPECT_GT(bank->scalar_steps, 0U);
+}
+
+TEST(Bank, WholeVectorsAndLeftoverLanesRunLikeScalar) {
+  // 40 lanes: whole 16 or 32 lane vectors, then lanes one at a time.
+  auto bank = std::make_unique<cpu6502_bank<40>>();
+  std::vector<std::unique_ptr<cpu6502>> refs;
+  load(*bank, refs);
+
+  bank->exec_until_hlt();
+  for (auto& ref : refs) {
+    ref->exec_until_hlt();
+  }
+
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    EXPECT_EQ(bank->cycles[i], refs[i]->cycles) << "lane " << i;
+    EXPECT_TRUE(same_state(bank->lane(i), *refs[i])) << "lane " << i;
+  }
+}
+
+TEST(Bank, SeesStoresToItsCode) {
+  // loop: LDX #$00; STA loop+1; DEY; BNE loop; HLT
+  // The first time round every lane loads 0, the second its own A.
+  auto bank = std::make_unique<cpu6502_bank<4>>();
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    auto& cpu = bank->lane(i);
+    cpu.load_program({0xa2, 0x00, 0x8d, 0x01, 0x10, 0x88, 0xd0, 0xf8, 0x02});
+    cpu.A = static_cast<byte>(i);
+    cpu.Y = 0x02;
+  }
+
+  bank->exec_until_hlt();
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    EXPECT_EQ(bank->X[i], i) << "lane " << i;
+  }
+}
+
+TEST(Bank, Reconverges) {
+  // loop: DEY; BNE skip; NOP; skip: NOP; INX; BNE loop; HLT
+  // Only lane 1 falls through to the first NOP, the others wait for it at
+  // skip.
+  auto bank = std::make_unique<cpu6502_bank<4>>();
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    auto& cpu = bank->lane(i);
+    cpu.load_program({0x88, 0xd0, 0x01, 0xea, 0xea, 0xe8, 0xd0, 0xf8, 0x02});
+    cpu.X = 0xff;
+    cpu.Y = static_cast<byte>(i);
+  }
+
+  bank->exec_n(2);
+  EXPECT_EQ(bank->PC[0], 0x1004);
+  EXPECT_EQ(bank->PC[1], 0x1003);
+
+  bank->exec();
+  EXPECT_EQ(bank->scalar_steps, 1U);
+  EXPECT_EQ(bank->PC[0], 0x1004);
+  EXPECT_EQ(bank->PC[1], 0x1004);
+
+  bank->exec_until_hlt();
+  EXPECT_EQ(bank->lockstep_steps, 5U);
+  EXPECT_EQ(bank->scalar_steps, 1U);
+  EXPECT_EQ(bank->cycles[0], bank->cycles[1] - 1);
+}
+
+TEST(Bank, TakesLaneChanges) {
+  auto bank = std::make_unique<cpu6502_bank<2>>();
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    // LDA $2000; STA $2001; HLT
+    bank->lane(i).load_program({0xad, 0x00, 0x20, 0x8d, 0x01, 0x20, 0x02});
+  }
+  bank->lane(1).write(0x2000, 0x42);
+
+  bank->exec_n(2);
+  EXPECT_EQ(bank->lockstep_steps, 2U);
+  EXPECT_EQ(bank->A[0], 0x00);
+  EXPECT_EQ(bank->A[1], 0x42);
+  EXPECT_EQ(bank->lane(1).read(0x2001), 0x42);
+  EXPECT_TRUE(bank->lane(0).Z());
+}
+
+TEST(Bank, KeepsEditsAcrossLaneCalls) {
+  auto bank = std::make_unique<cpu6502_bank<2>>();
+  for (std::size_t i = 0; i < bank->lanes; i++) {
+    bank->lane(i).load_program({0xea, 0xea, 0x02});  // NOP; NOP; HLT
+  }
+
+  bank->exec();
+  bank->lane(0).X = 5;
+  bank->lane(0).Y = 6;
+
+  bank->exec();
+  EXPECT_EQ(bank->X[0], 5);
+  EXPECT_EQ(bank->Y[0], 6);
+  EXPECT_EQ(bank->lane(0).X, 5);
+}
+
+TEST(Bank, DivergentCodeRunsPerLane) {
+  auto bank = std::make_unique<cpu6502_bank<2>>();
+  bank->lane(0).load_program({0xa9, 0x01, 0x02});  // LDA #$01; HLT
+  bank->lane(1).load_program({0xa9, 0x02, 0x02});  // LDA #$02; HLT
+
+  bank->exec();
+  EXPECT_EQ(bank->scalar_steps, 1U);
+  EXPECT_EQ(bank->A[0], 0x01);
+  EXPECT_EQ(bank->A[1], 0x02);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "core.h"
+
+namespace {
+
+// LDX #$00; INX; CPX $2000; BNE -6; HLT
+constexpr std::array<byte, 8> count_up = {0xa2, 0x00, 0xe8, 0xec,
+                                          0x00, 0x20, 0xd0, 0xfa};
+
+}  // namespace
+
+TEST(Batch, RunsEveryJob) {
+  // The target count, stored by each job's own program.
+  std::vector<std::vector<byte>> programs;
+  for (int i = 1; i <= 100; i++) {
+    // LDA #i; STA $2000; then count_up; HLT
+    std::vector<byte> program = {0xa9, static_cast<byte>(i), 0x8d, 0x00, 0x20};
+    program.insert(program.end(), count_up.begin(), count_up.end());
+    program.push_back(0x02);
+    programs.push_back(program);
+  }
+
+  std::vector<batch_job> jobs(programs.size());
+  for (std::size_t i = 0; i < jobs.size(); i++) {
+    jobs[i].program = programs[i].data();
+    jobs[i].size = programs[i].size();
+  }
+
+  std::vector<batch_result> results(jobs.size());
+  run_batch(jobs.data(), jobs.size(), results.data(), 3);
+
+  for (std::size_t i = 0; i < results.size(); i++) {
+    EXPECT_TRUE(results[i].halted);
+    EXPECT_EQ(results[i].state.X, i + 1);
+    EXPECT_EQ(results[i].state.PC, 0x100d);
+    EXPECT_EQ(results[i].instructions, 2 + 1 + 3 * (i + 1));
+  }
+}
+
+TEST(Batch, StartsCleanAndStops) {
+  // LDA $2000; INC $2000; JMP $1000
+  std::vector<byte> program = {0xad, 0x00, 0x20, 0xee, 0x00,
+                               0x20, 0x4c, 0x00, 0x10};
+
+  std::vector<batch_job> jobs(2);
+  for (auto& job : jobs) {
+    job.program = program.data();
+    job.size = program.size();
+  }
+  jobs[0].budget = 10;
+  jobs[1].stop = 0x1006;
+  jobs[1].initial.X = 0x42;
+
+  std::vector<batch_result> results(jobs.size());
+  run_batch(jobs.data(), jobs.size(), results.data(), 1);
+
+  EXPECT_FALSE(results[0].halted);
+  EXPECT_EQ(results[0].instructions, 10U);
+  EXPECT_TRUE(results[1].halted);
+  EXPECT_EQ(results[1].instructions, 2U);
+  EXPECT_EQ(results[1].state.A, 0x00);
+  EXPECT_EQ(results[1].state.X, 0x42);
+}
+
+TEST(Batch, RethrowsJobErrors) {
+  std::vector<byte> program(0x10);
+  std::vector<batch_job> jobs(40);
+  for (auto& job : jobs) {
+    job.program = program.data();
+    job.size = program.size();
+    job.budget = 1;
+  }
+  jobs[20].origin = 0xfff8;
+
+  std::vector<batch_result> results(jobs.size());
+
+  EXPECT_THROW(run_batch(jobs.data(), jobs.size(), results.data(), 2),
+               std::length_error);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+constexpr auto fib(cpu6502& cpu) -> void {
+  cpu.load_program(
+      {0xa9, 0x00, 0x8d, 0x00, 0x12, 0x8d, 0x01, 0x12, 0xe8, 0xa9,
+       0x01, 0x8d, 0x02, 0x12, 0xa9, 0x00, 0x8d, 0x03, 0x12, 0xa9,
+       0x00, 0x85, 0x02, 0x85, 0x03, 0xa9, 0x01, 0x85, 0x04, 0xa9,
+       0x00, 0x85, 0x05, 0xa9, 0x04, 0x85, 0x00, 0xa9, 0x12, 0x85,
+       0x01, 0x18, 0xa5, 0x02, 0x65, 0x04, 0x85, 0x06, 0xa5, 0x03,
+       0x65, 0x05, 0x85, 0x07, 0xa0, 0x00, 0xa5, 0x06, 0x91, 0x00,
+       0xc8, 0xa5, 0x07, 0x91, 0x00, 0xa5, 0x04, 0x85, 0x02, 0xa5,
+       0x05, 0x85, 0x03, 0xa5, 0x06, 0x85, 0x04, 0xa5, 0x07, 0x85,
+       0x05, 0x18, 0xa5, 0x00, 0x69, 0x02, 0x85, 0x00, 0xa5, 0x01,
+       0x69, 0x00, 0x85, 0x01, 0xa5, 0x01, 0xc9, 0xff, 0xb0, 0x03,
+       0x4c, 0x29, 0x10, 0x02});
+}
+
+// LDX #$00
+// loop: LDA #$05     ; operand patched by the INC below
+//       INX
+//       INC loop+1
+//       CPX #$03
+//       BNE loop
+// HLT
+auto self_modifying(cpu6502& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0xa9, 0x05, 0xe8, 0xee, 0x03, 0x10, 0xe0, 0x03,
+                    0xd0, 0xf6, 0x02});
+}
+
+}  // namespace
+
+TEST(BlockEngine, ExecUntilHltMatchesInterpreter) {
+  auto plain = std::make_unique<cpu6502>();
+  fib(*plain);
+  auto blocks = std::make_unique<cpu6502>(*plain);
+
+  plain->exec_until_hlt();
+
+  block_engine engine(*blocks);
+  engine.exec_until_hlt();
+
+  EXPECT_TRUE(same_state(*plain, *blocks));
+  EXPECT_EQ(plain->cycles, blocks->cycles);
+  EXPECT_GT(engine.chained, 0);
+  EXPECT_LT(engine.blocks_built, 16);
+}
+
+TEST(BlockEngine, ExecNMatchesInterpreter) {
+  for (int count : {0, 1, 7, 13, 64, 1000, 12345}) {
+    auto plain = std::make_unique<cpu6502>();
+    fib(*plain);
+    auto blocks = std::make_unique<cpu6502>(*plain);
+
+    plain->exec_n(count);
+
+    block_engine engine(*blocks);
+    engine.exec_n(count);
+
+    EXPECT_TRUE(same_state(*plain, *blocks)) << count << " instructions";
+    EXPECT_EQ(plain->cycles, blocks->cycles) << count << " instructions";
+  }
+}
+
+TEST(BlockEngine, SelfModifyingCode) {
+  auto plain = std::make_unique<cpu6502>();
+  self_modifying(*plain);
+  auto blocks = std::make_unique<cpu6502>(*plain);
+
+  plain->exec_until_hlt();
+
+  block_engine engine(*blocks);
+  engine.exec_until_hlt();
+
+  EXPECT_EQ(blocks->A, 0x07);
+  EXPECT_TRUE(same_state(*plain, *blocks));
+  EXPECT_EQ(plain->cycles, blocks->cycles);
+  EXPECT_GT(engine.flushes, 0);
+}
+
+TEST(BlockEngine, HltRunsAsNopInExecN) {
+  cpu6502 plain;
+  // HLT; LDA #$01; HLT; LDA #$02
+  plain.load_program({0x02, 0xa9, 0x01, 0x02, 0xa9, 0x02});
+  cpu6502 blocks = plain;
+
+  plain.exec_n(4);
+
+  block_engine engine(blocks);
+  engine.exec_n(4);
+
+  EXPECT_EQ(blocks.A, 0x02);
+  EXPECT_TRUE(same_state(plain, blocks));
+  EXPECT_EQ(plain.cycles, blocks.cycles);
+}
+
+TEST(BlockEngine, Lockstep) {
+  auto cpu = std::make_unique<cpu6502>();
+  fib(*cpu);
+
+  block_engine engine(*cpu);
+  engine.lockstep(true);
+  engine.exec_n(5000);
+
+  EXPECT_FALSE(engine.diverged());
+
+  // Corrupt the engine's cpu behind its back, the next block must notice.
+  cpu->Y ^= 0xff;
+  engine.exec_n(5000);
+
+  ASSERT_TRUE(engine.diverged());
+  EXPECT_NE(engine.reference()->Y, cpu->Y);
+}
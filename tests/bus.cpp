@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+
+namespace {
+
+// Records writes and answers reads with the low byte of the address.
+class echo_device : public bus_device {
+ public:
+  auto read(word addr) -> byte override {
+    reads++;
+    return static_cast<byte>(addr);
+  }
+
+  auto write(word addr, byte data) -> void override {
+    writes.push_back({addr, data});
+  }
+
+  struct access {
+    word addr;
+    byte data;
+  };
+
+  int reads = 0;
+  std::vector<access> writes;
+};
+
+}  // namespace
+
+TEST(PagedMemory, RamByDefault) {
+  paged_memory memory;
+  memory.write(0x1234, 0x56);
+
+  EXPECT_EQ(memory.read(0x1234), 0x56);
+  EXPECT_EQ(memory.read(0x1235), 0x00);
+  EXPECT_TRUE(memory.writable(0x12));
+}
+
+TEST(PagedMemory, RomIgnoresWrites) {
+  std::array<byte, 0x200> rom{};
+  rom[0x101] = 0xaa;
+
+  paged_memory memory;
+  memory.map_rom(0xe0, 2, rom.data());
+  memory.write(0xe101, 0x55);
+
+  EXPECT_EQ(memory.read(0xe101), 0xaa);
+  EXPECT_EQ(rom[0x101], 0xaa);
+  EXPECT_FALSE(memory.writable(0xe1));
+}
+
+TEST(PagedMemory, RamKeepsContentsWhenRemapped) {
+  std::array<byte, 0x100> rom{};
+  paged_memory memory;
+  memory.write(0x8000, 0x11);
+  memory.map_rom(0x80, 1, rom.data());
+
+  EXPECT_EQ(memory.read(0x8000), 0x00);
+
+  memory.map_ram(0x80, 1);
+
+  EXPECT_EQ(memory.read(0x8000), 0x11);
+}
+
+TEST(PagedMemory, CopiesOwnRam) {
+  echo_device device;
+  paged_memory memory;
+  memory.map_device(0xd0, 1, device);
+  memory.write(0x0200, 0x01);
+
+  auto copy = memory;
+  copy.write(0x0200, 0x02);
+
+  EXPECT_EQ(memory.read(0x0200), 0x01);
+  EXPECT_EQ(copy.read(0x0200), 0x02);
+  EXPECT_EQ(copy.read(0xd042), 0x42);
+  EXPECT_EQ(copy.device(0xd0), &device);
+  EXPECT_EQ(device.reads, 1);
+}
+
+TEST(PagedMemory, SharesZeroFrame) {
+  paged_memory memory;
+
+  EXPECT_EQ(memory.owned_frames(), 0U);
+
+  memory.write(0x1234, 0x56);
+  memory.write(0x1f00, 0x78);
+
+  EXPECT_EQ(memory.owned_frames(), 1U);
+  EXPECT_EQ(memory.read(0x2234), 0x00);
+}
+
+TEST(PagedMemory, CopiesFrameOnWrite) {
+  paged_memory memory;
+  memory.write(0x0200, 0x01);
+  memory.write(0x4000, 0x02);
+
+  auto copy = memory;
+
+  EXPECT_EQ(copy.owned_frames(), 0U);
+  EXPECT_TRUE(copy.writable(0x02));
+
+  copy.write(0x0201, 0x03);
+
+  EXPECT_EQ(copy.owned_frames(), 1U);
+
+  memory.write(0x4001, 0x04);
+
+  EXPECT_EQ(memory.read(0x0201), 0x00);
+  EXPECT_EQ(copy.read(0x0200), 0x01);
+  EXPECT_EQ(copy.read(0x4001), 0x00);
+  EXPECT_EQ(memory.read(0x4000), 0x02);
+}
+
+TEST(PagedMemory, CopyOnWriteKeepsRom) {
+  std::array<byte, 0x100> rom{};
+  rom[0x10] = 0xaa;
+
+  paged_memory memory;
+  memory.map_rom(0x01, 1, rom.data());
+
+  auto copy = memory;
+  copy.write(0x0010, 0x55);
+  copy.write(0x0110, 0x55);
+
+  EXPECT_EQ(copy.read(0x0010), 0x55);
+  EXPECT_EQ(copy.read(0x0110), 0xaa);
+  EXPECT_EQ(memory.read(0x0010), 0x00);
+}
+
+TEST(PagedMemory, WritesInPlaceOnceCopyIsGone) {
+  paged_memory memory;
+  memory.write(0x0200, 0x01);
+
+  { auto copy = memory; }
+
+  memory.write(0x0200, 0x02);
+
+  EXPECT_EQ(memory.read(0x0200), 0x02);
+  EXPECT_EQ(memory.owned_frames(), 1U);
+}
+
+TEST(RomImage, PadsToPages) {
+  rom_image image({0x01, 0x02, 0x03});
+
+  EXPECT_EQ(image.size(), 0x100U);
+  EXPECT_EQ(image.pages(), 1U);
+  EXPECT_EQ(image.data()[2], 0x03);
+  EXPECT_EQ(image.data()[3], 0x00);
+}
+
+TEST(RomImage, SharedBetweenMemories) {
+  paged_memory first;
+  paged_memory second;
+
+  {
+    std::vector<byte> bytes(0x2000, 0xea);
+    rom_image image(std::move(bytes));
+    first.map_rom(0xe0, image);
+    first.map_rom(0xf0, image);
+    second.map_rom(0xe0, image);
+
+    EXPECT_EQ(image.use_count(), 3);
+  }
+
+  first.write(0xe000, 0x00);
+
+  EXPECT_EQ(first.read(0xe000), 0xea);
+  EXPECT_EQ(first.read(0xffff), 0xea);
+  EXPECT_EQ(second.read(0xe123), 0xea);
+  EXPECT_FALSE(second.writable(0xe1));
+}
+
+TEST(RomImage, HeldByCopies) {
+  rom_image image({0x42});
+  paged_memory memory;
+  memory.map_rom(0xe0, image);
+  auto copy = memory;
+
+  EXPECT_EQ(image.use_count(), 3);
+}
+
+TEST(RomImage, TrapsWrites) {
+  write_trap trap;
+  rom_image image({0xaa});
+  paged_memory memory;
+  memory.map_rom(0xf0, image, &trap);
+
+  EXPECT_EQ(memory.read(0xf000), 0xaa);
+  EXPECT_THROW(memory.write(0xf000, 0x00), std::runtime_error);
+  EXPECT_EQ(memory.read(0xf000), 0xaa);
+}
+
+TEST(BusCpu, Devices) {
+  echo_device device;
+  auto cpu = std::make_unique<bus_cpu6502>();
+  cpu->memory.map_device(0xd0, 1, device);
+
+  // LDA $d010; STA $d020; STA $0300; HLT
+  cpu->load_program({0xad, 0x10, 0xd0, 0x8d, 0x20, 0xd0, 0x8d, 0x00, 0x03,
+                     0x02});
+  cpu->exec_until_hlt();
+
+  EXPECT_EQ(cpu->A, 0x10);
+  EXPECT_EQ(device.reads, 1);
+  ASSERT_EQ(device.writes.size(), 1U);
+  EXPECT_EQ(device.writes[0].addr, 0xd020);
+  EXPECT_EQ(device.writes[0].data, 0x10);
+  EXPECT_EQ(cpu->read(0x0300), 0x10);
+}
+
+TEST(BusCpu, UndoesOnlyRam) {
+  using undo_bus_cpu =
+      basic_cpu6502<paged_memory, unchecked, undo_trace<16>, cycle_timing>;
+
+  echo_device device;
+  auto cpu = std::make_unique<undo_bus_cpu>();
+  cpu->memory.map_device(0xd0, 1, device);
+
+  // LDA #$42; STA $d020; STA $0300; HLT
+  cpu->load_program({0xa9, 0x42, 0x8d, 0x20, 0xd0, 0x8d, 0x00, 0x03, 0x02});
+  cpu->exec_n(3);
+  EXPECT_EQ(cpu->step_back(2), 2U);
+
+  // The store to the device read nothing from it, and is not taken back.
+  EXPECT_EQ(device.reads, 0);
+  ASSERT_EQ(device.writes.size(), 1U);
+  EXPECT_EQ(cpu->read(0x0300), 0x00);
+  EXPECT_EQ(cpu->PC, 0x1002);
+}
+
+TEST(BusCpu, RunsLikeFlat) {
+  auto run = [](auto& cpu) {
+    // LDX #$00; TXA; STA $2000,X; INX; BNE -7; HLT
+    cpu.load_program({0xa2, 0x00, 0x8a, 0x9d, 0x00, 0x20, 0xe8, 0xd0, 0xf9,
+                      0x02});
+    cpu.exec_until_hlt();
+  };
+
+  auto flat = std::make_unique<cpu6502>();
+  auto paged = std::make_unique<bus_cpu6502>();
+  run(*flat);
+  run(*paged);
+
+  EXPECT_TRUE(same_state(*flat, *paged));
+}
+
+TEST(BusCpu, Fork) {
+  auto parent = std::make_unique<bus_cpu6502>();
+
+  // LDX #$00; INX; STX $0300; HLT
+  parent->load_program({0xa2, 0x00, 0xe8, 0x8e, 0x00, 0x03, 0x02});
+  parent->exec();
+
+  auto child = std::make_unique<bus_cpu6502>(*parent);
+  child->X = 0x40;
+  child->exec_until_hlt();
+  parent->exec_until_hlt();
+
+  EXPECT_EQ(child->read(0x0300), 0x41);
+  EXPECT_EQ(parent->read(0x0300), 0x01);
+  EXPECT_EQ(child->memory.owned_frames(), 1U);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+// LDX #$00
+// loop: LDA #$05     ; operand patched by the INC below
+//       INX
+//       INC loop+1
+//       CPX #$03
+//       BNE loop
+// HLT
+constexpr auto self_modifying(cpu6502& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0xa9, 0x05, 0xe8, 0xee, 0x03, 0x10, 0xe0, 0x03,
+                    0xd0, 0xf6, 0x02});
+}
+
+}  // namespace
+
+TEST(DecodeCache, Constexpr) {
+  // GCC 12 does not accept a constexpr cpu6502 whose icache ever pointed at a
+  // local, so the comparison happens inside the constant evaluation.
+  constexpr bool same = [] {
+    cpu6502 plain;
+    self_modifying(plain);
+    plain.exec_until_hlt();
+
+    decode_cache cache;
+    cpu6502 cached;
+    self_modifying(cached);
+    cached.attach(&cache);
+    cached.exec_until_hlt();
+
+    return plain.A == 0x07 && plain.read(0x1003) == 0x08 &&
+           same_state(plain, cached) && cache.hits == 8;
+  }();
+
+  HK_TEST(same);
+}
+
+TEST(DecodeCache, SelfModifyingCode) {
+  decode_cache cache;
+  cpu6502 cpu;
+  self_modifying(cpu);
+  cpu.attach(&cache);
+
+  cpu.exec_until_hlt();
+
+  EXPECT_EQ(cpu.A, 0x07);
+  EXPECT_EQ(cpu.X, 0x03);
+  EXPECT_EQ(cpu.read(0x1003), 0x08);
+
+  // The LDA is decoded again after each INC patches it, everything else in
+  // the loop comes from the cache.
+  EXPECT_EQ(cache.misses, 8);
+  EXPECT_EQ(cache.hits, 8);
+  EXPECT_EQ(cache.invalidations, 3);
+}
+
+TEST(DecodeCache, WritesOutsideCodeDoNotInvalidate) {
+  decode_cache cache;
+  cpu6502 cpu;
+  // LDA #$01; STA $2000; HLT
+  cpu.load_program({0xa9, 0x01, 0x8d, 0x00, 0x20, 0x02});
+  cpu.attach(&cache);
+
+  cpu.exec_n(2);
+  cpu.PC = 0x1000;
+  cpu.exec_n(2);
+
+  EXPECT_EQ(cpu.read(0x2000), 0x01);
+  EXPECT_EQ(cache.misses, 2);
+  EXPECT_EQ(cache.hits, 2);
+  EXPECT_EQ(cache.invalidations, 0);
+}
+
+TEST(DecodeCache, MatchesInterpreterEveryOpcode) {
+  for (int opcode = 0; opcode < 0x100; opcode++) {
+    cpu6502 plain;
+    for (int addr = 0; addr < 0x10000; addr++) {
+      plain.write(addr, static_cast<byte>(addr * 7 + (addr >> 8)));
+    }
+    plain.write(0x1000, static_cast<byte>(opcode));
+    plain.A = 0x5a;
+    plain.X = 0x13;
+    plain.Y = 0xf1;
+    plain.SP = 0xfd;
+
+    decode_cache cache;
+    cpu6502 cached = plain;
+    cached.attach(&cache);
+
+    plain.exec();
+    cached.exec();
+    cached.attach(nullptr);
+
+    EXPECT_TRUE(same_state(plain, cached)) << "opcode " << opcode;
+    EXPECT_EQ(plain.cycles, cached.cycles) << "opcode " << opcode;
+  }
+}
+
+TEST(DecodeCache, CopiesDoNotShareIt) {
+  decode_cache cache;
+  cpu6502 cpu;
+  // LDA #$01; HLT
+  cpu.load_program({0xa9, 0x01, 0x02});
+  cpu.attach(&cache);
+  cpu.exec();
+  cpu.PC = 0x1000;
+
+  auto copy = cpu;
+  EXPECT_EQ(copy.icache, nullptr);
+
+  // LDA #$02 in the copy only. Had the copy kept the cache, the write would
+  // have dropped the cached LDA and the copy decoded its own into it.
+  copy.write(0x1001, 0x02);
+  copy.exec();
+  cpu.exec();
+
+  EXPECT_EQ(copy.A, 0x02);
+  EXPECT_EQ(cpu.A, 0x01);
+  EXPECT_EQ(cache.hits, 1);
+  EXPECT_EQ(cache.invalidations, 0);
+
+  // Assigning keeps the cache of the cpu assigned to, flushed.
+  decode_cache other_cache;
+  cpu6502 other;
+  other.attach(&other_cache);
+  other = copy;
+  other.PC = 0x1000;
+  other.exec();
+
+  EXPECT_EQ(other.icache, &other_cache);
+  EXPECT_EQ(other.A, 0x02);
+  EXPECT_EQ(other_cache.misses, 1);
+
+  copy = cpu;
+  EXPECT_EQ(copy.icache, nullptr);
+}
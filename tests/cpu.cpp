@@ -14,13 +14,13 @@ TEST(ADC, Immediate) {
   }();
 
   HK_TEST(cpu.A == 0xf);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, ZeroPage) {
@@ -35,13 +35,13 @@ TEST(ADC, ZeroPage) {
   }();
 
   HK_TEST(cpu.A == 0x74);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, ZeroPageX) {
@@ -57,13 +57,13 @@ TEST(ADC, ZeroPageX) {
   }();
 
   HK_TEST(cpu.A == 0x74);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, Absolute) {
@@ -78,13 +78,13 @@ TEST(ADC, Absolute) {
   }();
 
   HK_TEST(cpu.A == 0x74);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, AbsoluteX) {
@@ -100,13 +100,13 @@ TEST(ADC, AbsoluteX) {
   }();
 
   HK_TEST(cpu.A == 0x76);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, AbsoluteY) {
@@ -122,13 +122,13 @@ TEST(ADC, AbsoluteY) {
   }();
 
   HK_TEST(cpu.A == 0x76);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, IndirectX) {
@@ -145,13 +145,13 @@ TEST(ADC, IndirectX) {
   }();
 
   HK_TEST(cpu.A == 0x05);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ADC, IndirectY) {
@@ -168,13 +168,13 @@ TEST(ADC, IndirectY) {
   }();
 
   HK_TEST(cpu.A == 0x05);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(AND, Immediate) {
@@ -188,13 +188,13 @@ TEST(AND, Immediate) {
   }();
 
   HK_TEST(cpu.A == 0x88);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(ASL, Implicit) {
@@ -208,13 +208,31 @@ TEST(ASL, Implicit) {
   }();
 
   HK_TEST(cpu.A == 0xf2);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
+}
+
+TEST(ASL, ZeroPage) {
+  constexpr cpu6502 cpu = [] {
+    cpu6502 cpu;
+    // ASL $ab
+    cpu.load_program({0x06, 0xab});
+    cpu.A = 0x11;
+    cpu.write(0x00ab, 0x81);
+    cpu.exec_n(1);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.read(0x00ab) == 0x02);
+  HK_TEST(cpu.A == 0x11);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(BCC, Relative) {
@@ -232,13 +250,13 @@ TEST(BCC, Relative) {
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BCS, Relative) {
@@ -250,20 +268,20 @@ TEST(BCS, Relative) {
     // label:
     //   ADC #$05
     cpu.load_program({0xb0, 0x02, 0x69, 0x11, 0x69, 0x05});
-    cpu.C = true;
+    cpu.C() = true;
     cpu.A = 0xf9;
     cpu.exec_n(2);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0xff);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BEQ, Relative) {
@@ -275,20 +293,20 @@ TEST(BEQ, Relative) {
     // label:
     //   ADC #$05
     cpu.load_program({0xf0, 0x02, 0x69, 0x11, 0x69, 0x05});
-    cpu.Z = true;
+    cpu.Z() = true;
     cpu.A = 0xf9;
     cpu.exec_n(2);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BIT, ZeroPage) {
@@ -303,13 +321,13 @@ TEST(BIT, ZeroPage) {
   }();
 
   HK_TEST(cpu.A == 0x55);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BMI, Relative) {
@@ -320,20 +338,20 @@ TEST(BMI, Relative) {
     // label:
     //   ADC #$05
     cpu.load_program({0x30, 0x02, 0x69, 0x11, 0x69, 0x05});
-    cpu.N = true;
+    cpu.N() = true;
     cpu.A = 0xf9;
     cpu.exec_n(2);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BNE, Relative) {
@@ -350,13 +368,13 @@ TEST(BNE, Relative) {
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BPL, Relative) {
@@ -373,13 +391,13 @@ TEST(BPL, Relative) {
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // TODO: BRK
@@ -398,13 +416,13 @@ TEST(BVC, Relative) {
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(BVS, Relative) {
@@ -415,20 +433,20 @@ TEST(BVS, Relative) {
     // label:
     //   ADC #$05
     cpu.load_program({0x70, 0x02, 0x69, 0x11, 0x69, 0x05});
-    cpu.V = true;
+    cpu.V() = true;
     cpu.A = 0xf9;
     cpu.exec_n(2);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0xfe);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Clear Carry Flag
@@ -438,18 +456,18 @@ TEST(CLC, Implied_Set) {
     cpu6502 cpu;
     // CLC
     cpu.load_program({0x18});
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Carry Flag
@@ -459,18 +477,18 @@ TEST(CLC, Implied_Unset) {
     cpu6502 cpu;
     // CLC
     cpu.load_program({0x18});
-    cpu.C = false;
+    cpu.C() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Decimal Mode
@@ -480,18 +498,18 @@ TEST(CLD, Implied_Set) {
     cpu6502 cpu;
     // CLD
     cpu.load_program({0xd8});
-    cpu.D = true;
+    cpu.D() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Decimal Mode
@@ -501,18 +519,18 @@ TEST(CLD, Implied_Unset) {
     cpu6502 cpu;
     // CLD
     cpu.load_program({0xd8});
-    cpu.D = false;
+    cpu.D() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Interrupt Disable
@@ -522,18 +540,18 @@ TEST(CLI, Implied_Set) {
     cpu6502 cpu;
     // CLI
     cpu.load_program({0x58});
-    cpu.I = true;
+    cpu.I() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Interrupt Disable
@@ -543,18 +561,18 @@ TEST(CLI, Implied_Unset) {
     cpu6502 cpu;
     // CLI
     cpu.load_program({0x58});
-    cpu.I = false;
+    cpu.I() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Overflow Flag
@@ -564,18 +582,18 @@ TEST(CLV, Implied_Set) {
     cpu6502 cpu;
     // CLV
     cpu.load_program({0xb8});
-    cpu.V = true;
+    cpu.V() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Clear Overflow Flag
@@ -585,18 +603,18 @@ TEST(CLV, Implied_Unset) {
     cpu6502 cpu;
     // CLV
     cpu.load_program({0xb8});
-    cpu.V = false;
+    cpu.V() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Compare
@@ -611,13 +629,13 @@ TEST(CMP, Greater) {
   }();
 
   HK_TEST(cpu.A == 0x10);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Compare
@@ -632,13 +650,13 @@ TEST(CMP, Less) {
   }();
 
   HK_TEST(cpu.A == 0x10);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Compare
@@ -653,13 +671,13 @@ TEST(CMP, Equal) {
   }();
 
   HK_TEST(cpu.A == 0x10);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Compare X Register
@@ -674,13 +692,13 @@ TEST(CPX, Greater) {
   }();
 
   HK_TEST(cpu.X == 0x10);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Compare X Register
@@ -695,13 +713,13 @@ TEST(CPX, Less) {
   }();
 
   HK_TEST(cpu.X == 0x10);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Compare X Register
@@ -716,13 +734,13 @@ TEST(CPX, Equal) {
   }();
 
   HK_TEST(cpu.X == 0x10);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Compare Y Register
@@ -737,13 +755,13 @@ TEST(CPY, Greater) {
   }();
 
   HK_TEST(cpu.Y == 0x10);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Compare Y Register
@@ -758,13 +776,13 @@ TEST(CPY, Less) {
   }();
 
   HK_TEST(cpu.Y == 0x10);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Compare Y Register
@@ -779,13 +797,13 @@ TEST(CPY, Equal) {
   }();
 
   HK_TEST(cpu.Y == 0x10);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement Memory
@@ -800,13 +818,13 @@ TEST(DEC, Positive) {
   }();
 
   HK_TEST(cpu.read(0xabcd) == 0x0f);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement Memory
@@ -821,13 +839,13 @@ TEST(DEC, Zero) {
   }();
 
   HK_TEST(cpu.read(0xabcd) == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement Memory
@@ -842,13 +860,13 @@ TEST(DEC, Negative) {
   }();
 
   HK_TEST(cpu.read(0xabcd) == 0xff);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Decrement X Register
@@ -863,13 +881,13 @@ TEST(DEX, Positive) {
   }();
 
   HK_TEST(cpu.X == 0x0f);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement X Register
@@ -884,13 +902,13 @@ TEST(DEX, Zero) {
   }();
 
   HK_TEST(cpu.X == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement X Register
@@ -905,13 +923,13 @@ TEST(DEX, Negative) {
   }();
 
   HK_TEST(cpu.X == 0xff);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Decrement Y Register
@@ -926,13 +944,13 @@ TEST(DEY, Positive) {
   }();
 
   HK_TEST(cpu.Y == 0x0f);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement Y Register
@@ -947,13 +965,13 @@ TEST(DEY, Zero) {
   }();
 
   HK_TEST(cpu.Y == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Decrement Y Register
@@ -968,13 +986,13 @@ TEST(DEY, Negative) {
   }();
 
   HK_TEST(cpu.Y == 0xff);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Exclusive OR
@@ -989,13 +1007,13 @@ TEST(EOR, Positive) {
   }();
 
   HK_TEST(cpu.A == 0x66);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Exclusive OR
@@ -1010,13 +1028,13 @@ TEST(EOR, Zero) {
   }();
 
   HK_TEST(cpu.A == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Exclusive OR
@@ -1031,13 +1049,13 @@ TEST(EOR, Negative) {
   }();
 
   HK_TEST(cpu.A == 0xd5);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Increment Memory
@@ -1052,13 +1070,13 @@ TEST(INC, Positive) {
   }();
 
   HK_TEST(cpu.read(0xabcd) == 0x11);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Increment Memory
@@ -1073,13 +1091,13 @@ TEST(INC, Zero) {
   }();
 
   HK_TEST(cpu.read(0xabcd) == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Increment Memory
@@ -1094,13 +1112,13 @@ TEST(INC, Negative) {
   }();
 
   HK_TEST(cpu.read(0xabcd) == 0x80);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Increment X Register
@@ -1115,13 +1133,13 @@ TEST(INX, Positive) {
   }();
 
   HK_TEST(cpu.X == 0x11);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Increment X Register
@@ -1136,13 +1154,13 @@ TEST(INX, Zero) {
   }();
 
   HK_TEST(cpu.X == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Increment X Register
@@ -1157,13 +1175,13 @@ TEST(INX, Negative) {
   }();
 
   HK_TEST(cpu.X == 0x80);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Increment Y Register
@@ -1178,13 +1196,13 @@ TEST(INY, Positive) {
   }();
 
   HK_TEST(cpu.Y == 0x11);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Increment Y Register
@@ -1199,13 +1217,13 @@ TEST(INY, Zero) {
   }();
 
   HK_TEST(cpu.Y == 0x00);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Increment Y Register
@@ -1220,13 +1238,13 @@ TEST(INY, Negative) {
   }();
 
   HK_TEST(cpu.Y == 0x80);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Subtract with Carry
@@ -1236,19 +1254,19 @@ TEST(SBC, Borrowed) {
     // SBC #$30
     cpu.load_program({0xe9, 0x30});
     cpu.A = 0x50;
-    cpu.C = false;
+    cpu.C() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0x1f);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Subtract with Carry
@@ -1258,19 +1276,19 @@ TEST(SBC, Positive) {
     // SBC #$30
     cpu.load_program({0xe9, 0x30});
     cpu.A = 0x50;
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0x20);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Subtract with Carry
@@ -1280,19 +1298,19 @@ TEST(SBC, Negative) {
     // SBC #$50
     cpu.load_program({0xe9, 0x50});
     cpu.A = 0x30;
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0xe0);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 // Subtract with Carry
@@ -1302,19 +1320,19 @@ TEST(SBC, Zero) {
     // SBC #$30
     cpu.load_program({0xe9, 0x30});
     cpu.A = 0x30;
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0x00);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == true);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Subtract with Carry
@@ -1324,19 +1342,19 @@ TEST(SBC, Overflow) {
     // SBC #$01
     cpu.load_program({0xe9, 0x01});
     cpu.A = 0x80;
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0x7f);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == true);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == true);
+  HK_TEST(cpu.N() == false);
 }
 
 // Set Carry Flag
@@ -1346,18 +1364,18 @@ TEST(SEC, Implied_Set) {
     cpu6502 cpu;
     // SEC
     cpu.load_program({0x38});
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Set Carry Flag
@@ -1367,18 +1385,18 @@ TEST(SEC, Implied_Unset) {
     cpu6502 cpu;
     // SEC
     cpu.load_program({0x38});
-    cpu.C = false;
+    cpu.C() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Set Decimal Flag
@@ -1388,18 +1406,18 @@ TEST(SED, Implied_Set) {
     cpu6502 cpu;
     // SED
     cpu.load_program({0xf8});
-    cpu.D = true;
+    cpu.D() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == true);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == true);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Set Decimal Flag
@@ -1409,18 +1427,18 @@ TEST(SED, Implied_Unset) {
     cpu6502 cpu;
     // SED
     cpu.load_program({0xf8});
-    cpu.D = false;
+    cpu.D() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == true);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == true);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Set Interrupt Disable
@@ -1430,18 +1448,18 @@ TEST(SEI, Implied_Set) {
     cpu6502 cpu;
     // SEI
     cpu.load_program({0x78});
-    cpu.I = true;
+    cpu.I() = true;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == true);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == true);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Set Interrupt Disable
@@ -1451,18 +1469,18 @@ TEST(SEI, Implied_Unset) {
     cpu6502 cpu;
     // SEI
     cpu.load_program({0x78});
-    cpu.I = false;
+    cpu.I() = false;
     cpu.exec_n(1);
     return cpu;
   }();
 
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == true);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == true);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Store Accumulator
@@ -1479,13 +1497,13 @@ TEST(STA, Absolute) {
 
   HK_TEST(cpu.A == 0x10);
   HK_TEST(cpu.read(0xabcd) == 0x10);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Store X Register
@@ -1502,13 +1520,13 @@ TEST(STX, Absolute) {
 
   HK_TEST(cpu.X == 0x10);
   HK_TEST(cpu.read(0xabcd) == 0x10);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 // Store Y Register
@@ -1525,13 +1543,13 @@ TEST(STY, Absolute) {
 
   HK_TEST(cpu.Y == 0x10);
   HK_TEST(cpu.read(0xabcd) == 0x10);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(JMP, Absolute) {
@@ -1571,8 +1589,8 @@ TEST(LDA, Absolute) {
   }();
 
   HK_TEST(cpu.A == 0x69);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(LDX, Absolute) {
@@ -1586,8 +1604,8 @@ TEST(LDX, Absolute) {
   }();
 
   HK_TEST(cpu.X == 0x69);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(LDY, Absolute) {
@@ -1601,8 +1619,8 @@ TEST(LDY, Absolute) {
   }();
 
   HK_TEST(cpu.Y == 0x69);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(LSR, Accumulator) {
@@ -1616,8 +1634,26 @@ TEST(LSR, Accumulator) {
   }();
 
   HK_TEST(cpu.A == 0x01);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == false);
+}
+
+TEST(LSR, ZeroPage) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+
+    cpu.load_program({0xa9, 0x02, 0x46, 0x10});
+    cpu.write(0x0010, 0x01);
+    cpu.exec_n(2);
+
+    return cpu;
+  }();
+
+  HK_TEST(cpu.read(0x0010) == 0x00);
+  HK_TEST(cpu.A == 0x02);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(ORA, Immediate) {
@@ -1631,8 +1667,8 @@ TEST(ORA, Immediate) {
   }();
 
   HK_TEST(cpu.A == 0xff);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(PHA, Implied) {
@@ -1655,8 +1691,8 @@ TEST(PHP, Implied) {
     cpu.load_program({0x08});
     cpu.exec_n(1);
 
-    cpu.B = true;
-    cpu.U = true;
+    cpu.B() = true;
+    cpu.U() = true;
 
     return cpu;
   }();
@@ -1684,8 +1720,8 @@ TEST(PLP, Implied) {
     cpu.load_program({0x08, 0x28});
     cpu.exec_n(2);
 
-    cpu.B = true;
-    cpu.U = true;
+    cpu.B() = true;
+    cpu.U() = true;
 
     return cpu;
   }();
@@ -1693,25 +1729,58 @@ TEST(PLP, Implied) {
   HK_TEST(cpu.getFlag() == cpu.getFlag());
 }
 
+TEST(PLP, KeepsUnusedSet) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    // LDA #$00; PHA; PLP
+    cpu.load_program({0xa9, 0x00, 0x48, 0x28});
+    cpu.exec_n(3);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.U() == true);
+  HK_TEST(cpu.getFlag() == 0x20);
+}
+
+TEST(PLP, PullsFlagsByte) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    // LDA #$c3; PHA; PLP
+    cpu.load_program({0xa9, 0xc3, 0x48, 0x28});
+    cpu.exec_n(3);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.N() == true);
+  HK_TEST(cpu.V() == true);
+  HK_TEST(cpu.U() == true);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.getFlag() == 0xe3);
+}
+
 TEST(ROL, Accumulator) {
   constexpr cpu6502 cpu = [] {
     cpu6502 cpu;
     // ROL
     cpu.load_program({0x2a});
-    cpu.C = true;
+    cpu.C() = true;
     cpu.A = 0xf9;
     cpu.exec_n(1);
     return cpu;
   }();
 
   HK_TEST(cpu.A == 0xf3);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
 }
 
 TEST(ROL, Absolute) {
@@ -1720,7 +1789,7 @@ TEST(ROL, Absolute) {
 
     cpu.load_program({0x2e, 0x34, 0x12});
     cpu.write(0x1234, 0xf9);
-    cpu.C = true;
+    cpu.C() = true;
     cpu.exec_n(1);
 
     return cpu;
@@ -1728,13 +1797,49 @@ TEST(ROL, Absolute) {
 
   HK_TEST(cpu.read(0x1234) == 0xf3);
   HK_TEST(cpu.A == 0x00);
-  HK_TEST(cpu.C == true);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == true);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == true);
+}
+
+TEST(ROR, Accumulator) {
+  constexpr cpu6502 cpu = [] {
+    cpu6502 cpu;
+    // ROR
+    cpu.load_program({0x6a});
+    cpu.C() = true;
+    cpu.A = 0x03;
+    cpu.exec_n(1);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.A == 0x81);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == true);
+}
+
+TEST(ROR, Absolute) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+
+    cpu.load_program({0x6e, 0x34, 0x12});
+    cpu.write(0x1234, 0x02);
+    cpu.A = 0x03;
+    cpu.exec_n(1);
+
+    return cpu;
+  }();
+
+  HK_TEST(cpu.read(0x1234) == 0x01);
+  HK_TEST(cpu.A == 0x03);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.N() == false);
 }
 
 TEST(HLT, Implied) {
@@ -1753,11 +1858,11 @@ TEST(HLT, Implied) {
 
   EXPECT_EQ(cpu.A, 0x13);
   HK_TEST(cpu.A == 0x13);
-  HK_TEST(cpu.C == false);
-  HK_TEST(cpu.Z == false);
-  HK_TEST(cpu.I == false);
-  HK_TEST(cpu.D == false);
-  HK_TEST(cpu.B == false);
-  HK_TEST(cpu.V == false);
-  HK_TEST(cpu.N == false);
+  HK_TEST(cpu.C() == false);
+  HK_TEST(cpu.Z() == false);
+  HK_TEST(cpu.I() == false);
+  HK_TEST(cpu.D() == false);
+  HK_TEST(cpu.B() == false);
+  HK_TEST(cpu.V() == false);
+  HK_TEST(cpu.N() == false);
 }
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+constexpr auto run(instructions program, int count, byte x = 0x00) {
+  cpu6502 cpu;
+  cpu.load_program(program);
+  cpu.X = x;
+  cpu.exec_n(count);
+  return cpu;
+}
+
+}  // namespace
+
+TEST(Cycles, BaseCounts) {
+  // LDA #$01; STA $0200; INC $0200; NOP
+  constexpr auto cpu = run({0xa9, 0x01, 0x8d, 0x00, 0x02, 0xee, 0x00, 0x02,
+                            0xea},
+                           4);
+
+  HK_TEST(cpu.cycles == 2 + 4 + 6 + 2);
+}
+
+TEST(Cycles, AbsoluteXPageCross) {
+  // LDA $10f0,X
+  constexpr auto same_page = run({0xbd, 0xf0, 0x10}, 1, 0x0f);
+  constexpr auto crossed = run({0xbd, 0xf0, 0x10}, 1, 0x10);
+
+  HK_TEST(same_page.cycles == 4);
+  HK_TEST(crossed.cycles == 5);
+}
+
+TEST(Cycles, StoresAlwaysPayPageCross) {
+  // STA $10f0,X
+  constexpr auto same_page = run({0x9d, 0xf0, 0x10}, 1, 0x0f);
+  constexpr auto crossed = run({0x9d, 0xf0, 0x10}, 1, 0x10);
+
+  HK_TEST(same_page.cycles == 5);
+  HK_TEST(crossed.cycles == 5);
+}
+
+TEST(Cycles, IndirectYPageCross) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    // LDA ($10),Y with $10 pointing at $20ff
+    cpu.load_program({0xb1, 0x10});
+    cpu.write16(0x0010, 0x20ff);
+    cpu.Y = 0x01;
+    cpu.exec_n(1);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.cycles == 6);
+}
+
+TEST(Cycles, Branches) {
+  // BNE +2 not taken (Z set by LDA #$00), taken, and taken across a page
+  constexpr auto not_taken = run({0xa9, 0x00, 0xd0, 0x02}, 2);
+  constexpr auto taken = run({0xa9, 0x01, 0xd0, 0x02}, 2);
+  constexpr auto crossed = run({0xa9, 0x01, 0xd0, 0x80}, 2);
+
+  HK_TEST(not_taken.cycles == 2 + 2);
+  HK_TEST(taken.cycles == 2 + 3);
+  HK_TEST(crossed.cycles == 2 + 4);
+}
+
+TEST(Cycles, ExecCycles) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    // NOP; NOP; NOP; INC $0200; NOP
+    cpu.load_program({0xea, 0xea, 0xea, 0xee, 0x00, 0x02, 0xea});
+    cpu.exec_cycles(7);
+    return cpu;
+  }();
+
+  // Stops after the INC, the first instruction to reach the budget.
+  HK_TEST(cpu.PC == 0x1006);
+  HK_TEST(cpu.cycles == 12);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+constexpr auto fib(cpu6502& cpu) -> void {
+  cpu.load_program(
+      {0xa9, 0x00, 0x8d, 0x00, 0x12, 0x8d, 0x01, 0x12, 0xe8, 0xa9,
+       0x01, 0x8d, 0x02, 0x12, 0xa9, 0x00, 0x8d, 0x03, 0x12, 0xa9,
+       0x00, 0x85, 0x02, 0x85, 0x03, 0xa9, 0x01, 0x85, 0x04, 0xa9,
+       0x00, 0x85, 0x05, 0xa9, 0x04, 0x85, 0x00, 0xa9, 0x12, 0x85,
+       0x01, 0x18, 0xa5, 0x02, 0x65, 0x04, 0x85, 0x06, 0xa5, 0x03,
+       0x65, 0x05, 0x85, 0x07, 0xa0, 0x00, 0xa5, 0x06, 0x91, 0x00,
+       0xc8, 0xa5, 0x07, 0x91, 0x00, 0xa5, 0x04, 0x85, 0x02, 0xa5,
+       0x05, 0x85, 0x03, 0xa5, 0x06, 0x85, 0x04, 0xa5, 0x07, 0x85,
+       0x05, 0x18, 0xa5, 0x00, 0x69, 0x02, 0x85, 0x00, 0xa5, 0x01,
+       0x69, 0x00, 0x85, 0x01, 0xa5, 0x01, 0xc9, 0xff, 0xb0, 0x03,
+       0x4c, 0x29, 0x10, 0x02});
+}
+
+// Pseudo random but deterministic memory contents, so every addressing mode
+// has something other than zero to read.
+auto scramble(cpu6502& cpu) -> void {
+  word seed = 0xace1;
+  for (int addr = 0; addr < 0x10000; addr++) {
+    seed = static_cast<word>((seed >> 1) ^ (-(seed & 1) & 0xb400));
+    cpu.write(addr, static_cast<byte>(seed));
+  }
+}
+
+}  // namespace
+
+TEST(Dispatch, SwitchMatchesTableConstexpr) {
+  constexpr auto run = [](bool use_switch) {
+    cpu6502 cpu;
+    // LDA #$40; ASL; ADC #$c1; ROR; TAX; INX; STX $10; SBC $10; PHP; PLA
+    cpu.load_program({0xa9, 0x40, 0x0a, 0x69, 0xc1, 0x6a, 0xaa, 0xe8, 0x86,
+                      0x10, 0xe5, 0x10, 0x08, 0x68});
+    for (int i = 0; i < 10; i++) {
+      if (use_switch) {
+        cpu.exec_switch();
+      } else {
+        cpu.exec_table();
+      }
+    }
+    return cpu;
+  };
+
+  constexpr cpu6502 table = run(false);
+  constexpr cpu6502 fused = run(true);
+
+  HK_TEST(same_state(table, fused));
+}
+
+TEST(Dispatch, SwitchMatchesTableEveryOpcode) {
+  for (int opcode = 0; opcode < 0x100; opcode++) {
+    cpu6502 table;
+    scramble(table);
+    table.write(0x1000, static_cast<byte>(opcode));
+    table.A = 0x5a;
+    table.X = 0x13;
+    table.Y = 0xf1;
+    table.SP = 0xfd;
+    table.setFlag(0x01);
+
+    cpu6502 fused = table;
+
+    table.exec_table();
+    fused.exec_switch();
+
+    EXPECT_TRUE(same_state(table, fused)) << "opcode " << opcode;
+    EXPECT_EQ(table.cycles, fused.cycles) << "opcode " << opcode;
+  }
+}
+
+TEST(Dispatch, SwitchMatchesTableFib) {
+  cpu6502 table;
+  fib(table);
+  cpu6502 fused = table;
+
+  while (table.read(table.PC) != 0x02) {
+    table.exec_table();
+    fused.exec_switch();
+  }
+
+  EXPECT_TRUE(same_state(table, fused));
+  EXPECT_EQ(table.cycles, fused.cycles);
+  EXPECT_EQ(table.read16(0x1204), 1);
+  EXPECT_EQ(table.read16(0x1204 + 2 * 22), 46368);
+}
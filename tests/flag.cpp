@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "test.h"
+
+TEST(LazyFlag, AssignAndRead) {
+  constexpr auto flags = [] {
+    lazy_flag<byte, 0x80> n;
+    lazy_flag<byte, 0xff, true> z;
+    n = true;
+    z = true;
+    return std::pair{n.value(), z.value()};
+  }();
+
+  HK_TEST(flags.first == true);
+  HK_TEST(flags.second == true);
+}
+
+TEST(LazyFlag, DefaultsToClear) {
+  constexpr lazy_flag<byte, 0x80> n;
+  constexpr lazy_flag<byte, 0xff, true> z;
+
+  HK_TEST(n == false);
+  HK_TEST(z == false);
+}
+
+TEST(LazyFlag, DerivesFromResult) {
+  constexpr auto flags = [] {
+    lazy_flag<byte, 0x80> n;
+    lazy_flag<byte, 0xff, true> z;
+    lazy_flag<word, 0x100> c;
+
+    // 0xff + 0x01, as ADC leaves it
+    word temp = 0x0100;
+    n.from(temp);
+    z.from(temp);
+    c.from(temp);
+
+    return (!n.value() ? 1 : 0) | (z.value() ? 2 : 0) | (c.value() ? 4 : 0);
+  }();
+
+  HK_TEST(flags == 7);
+}
+
+TEST(LazyFlag, CpuFlagsReadBack) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    // LDA #$80; ADC #$80
+    cpu.load_program({0xa9, 0x80, 0x69, 0x80});
+    cpu.exec_n(2);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.A == 0x00);
+  HK_TEST(cpu.Z() == true);
+  HK_TEST(cpu.N() == false);
+  HK_TEST(cpu.C() == true);
+  HK_TEST(cpu.V() == true);
+  HK_TEST(cpu.getFlag() == 0b01100011);
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "core.h"
+#include "jit.h"
+#include "test.h"
+
+namespace {
+
+auto fib(cpu6502& cpu) -> void {
+  cpu.load_program(
+      {0xa9, 0x00, 0x8d, 0x00, 0x12, 0x8d, 0x01, 0x12, 0xe8, 0xa9,
+       0x01, 0x8d, 0x02, 0x12, 0xa9, 0x00, 0x8d, 0x03, 0x12, 0xa9,
+       0x00, 0x85, 0x02, 0x85, 0x03, 0xa9, 0x01, 0x85, 0x04, 0xa9,
+       0x00, 0x85, 0x05, 0xa9, 0x04, 0x85, 0x00, 0xa9, 0x12, 0x85,
+       0x01, 0x18, 0xa5, 0x02, 0x65, 0x04, 0x85, 0x06, 0xa5, 0x03,
+       0x65, 0x05, 0x85, 0x07, 0xa0, 0x00, 0xa5, 0x06, 0x91, 0x00,
+       0xc8, 0xa5, 0x07, 0x91, 0x00, 0xa5, 0x04, 0x85, 0x02, 0xa5,
+       0x05, 0x85, 0x03, 0xa5, 0x06, 0x85, 0x04, 0xa5, 0x07, 0x85,
+       0x05, 0x18, 0xa5, 0x00, 0x69, 0x02, 0x85, 0x00, 0xa5, 0x01,
+       0x69, 0x00, 0x85, 0x01, 0xa5, 0x01, 0xc9, 0xff, 0xb0, 0x03,
+       0x4c, 0x29, 0x10, 0x02});
+}
+
+// See tests/block.cpp.
+auto self_modifying(cpu6502& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0xa9, 0x05, 0xe8, 0xee, 0x03, 0x10, 0xe0, 0x03,
+                    0xd0, 0xf6, 0x02});
+}
+
+// X from 0 to $3f: pushes X and the flags, calls a subroutine that drops
+// the return address and jumps back, then pulls the flags and X again.
+auto stack_loop(cpu6502& cpu, word origin) -> void {
+  auto sub = static_cast<word>(origin + 0x20);
+  auto back = static_cast<word>(origin + 0x08);
+  cpu.load_program({0xa2, 0x00, 0x8a, 0x48, 0x08, 0x20, static_cast<byte>(sub),
+                    static_cast<byte>(sub >> 8), 0x28, 0x68, 0xe8, 0xe0, 0x40,
+                    0xd0, 0xf3, 0x02},
+                   origin);
+  cpu.load_program({0x68, 0x68, 0x4c, static_cast<byte>(back),
+                    static_cast<byte>(back >> 8)},
+                   sub);
+  cpu.PC = origin;
+  cpu.SP = 0xff;
+}
+
+auto scramble(cpu6502& cpu, unsigned seed) -> void {
+  for (auto& cell : cpu.memory.bytes) {
+    seed = seed * 1103515245 + 12345;
+    cell = static_cast<byte>(seed >> 16);
+  }
+  cpu.A = static_cast<byte>(seed >> 3);
+  cpu.X = static_cast<byte>(seed >> 11);
+  cpu.Y = static_cast<byte>(seed >> 19);
+  cpu.C() = (seed & 1) != 0;
+  cpu.V() = (seed & 2) != 0;
+  cpu.N() = (seed & 4) != 0;
+  cpu.Z() = !cpu.N() && (seed & 8) != 0;
+}
+
+}  // namespace
+
+TEST(Jit, FibMatchesInterpreter) {
+  auto plain = std::make_unique<cpu6502>();
+  fib(*plain);
+  auto native = std::make_unique<cpu6502>(*plain);
+
+  plain->exec_until_hlt();
+
+  jit_engine engine(*native);
+  engine.exec_until_hlt();
+
+  EXPECT_TRUE(same_state(*plain, *native));
+  EXPECT_EQ(plain->cycles, native->cycles);
+  if (jit_engine::available()) {
+    EXPECT_GT(engine.native_instructions, engine.interpreted_instructions);
+  }
+}
+
+TEST(Jit, ExecNMatchesInterpreter) {
+  for (int count : {0, 1, 7, 13, 64, 1000, 12345}) {
+    auto plain = std::make_unique<cpu6502>();
+    fib(*plain);
+    auto native = std::make_unique<cpu6502>(*plain);
+
+    plain->exec_n(count);
+
+    jit_engine engine(*native);
+    engine.exec_n(count);
+
+    EXPECT_TRUE(same_state(*plain, *native)) << count << " instructions";
+    EXPECT_EQ(plain->cycles, native->cycles) << count << " instructions";
+  }
+}
+
+TEST(Jit, SelfModifyingCode) {
+  auto plain = std::make_unique<cpu6502>();
+  self_modifying(*plain);
+  auto native = std::make_unique<cpu6502>(*plain);
+
+  plain->exec_until_hlt();
+
+  jit_engine engine(*native);
+  engine.exec_until_hlt();
+
+  EXPECT_EQ(native->A, 0x07);
+  EXPECT_TRUE(same_state(*plain, *native));
+  EXPECT_EQ(plain->cycles, native->cycles);
+}
+
+// Every opcode followed by a backwards JMP, so each gets hot enough to be
+// compiled, against random memory and registers.
+TEST(Jit, MatchesInterpreterEveryOpcode) {
+  for (int opcode = 0; opcode < 0x100; opcode++) {
+    if (opcode == 0x02) {
+      continue;
+    }
+    for (unsigned seed = 1; seed <= 8; seed++) {
+      auto plain = std::make_unique<cpu6502>();
+      scramble(*plain, seed * 0x100 + opcode);
+      plain->PC = 0x1000;
+      plain->memory.bytes[0x1000] = static_cast<byte>(opcode);
+      // JMP $1000 after the instruction, where the operands were random.
+      auto next = 0x1000 + cpu6502::length(static_cast<byte>(opcode));
+      plain->memory.bytes[next] = 0x4c;
+      plain->memory.bytes[next + 1] = 0x00;
+      plain->memory.bytes[next + 2] = 0x10;
+      auto native = std::make_unique<cpu6502>(*plain);
+
+      plain->exec_n(6);
+
+      jit_engine engine(*native);
+      engine.exec_n(6);
+
+      EXPECT_TRUE(same_state(*plain, *native))
+          << "opcode " << opcode << " seed " << seed;
+      EXPECT_EQ(plain->cycles, native->cycles)
+          << "opcode " << opcode << " seed " << seed;
+    }
+  }
+}
+
+// From $0140 the code shares the stack page, so the pushes are left to the
+// interpreter.
+TEST(Jit, StackOpsMatchInterpreter) {
+  for (word origin : {0x1000, 0x0140}) {
+    auto plain = std::make_unique<cpu6502>();
+    stack_loop(*plain, origin);
+    auto native = std::make_unique<cpu6502>(*plain);
+
+    plain->exec_until_hlt();
+
+    jit_engine engine(*native);
+    engine.exec_until_hlt();
+
+    EXPECT_TRUE(same_state(*plain, *native)) << "origin " << origin;
+    EXPECT_EQ(plain->cycles, native->cycles) << "origin " << origin;
+    if (jit_engine::available() && origin == 0x1000) {
+      EXPECT_LT(engine.interpreted_instructions, 0x40);
+    } else {
+      EXPECT_GE(engine.interpreted_instructions, 3 * 0x40);
+    }
+  }
+}
+
+TEST(Jit, CodeIsNeverWritableAndExecutable) {
+  if (!jit_engine::available()) {
+    GTEST_SKIP();
+  }
+
+  auto cpu = std::make_unique<cpu6502>();
+  fib(*cpu);
+  jit_engine engine(*cpu);
+  engine.exec_until_hlt();
+  ASSERT_GT(engine.blocks_compiled, 0);
+
+  std::ifstream maps("/proc/self/maps");
+  for (std::string line; std::getline(maps, line);) {
+    EXPECT_EQ(line.find(" rwx"), std::string::npos) << line;
+  }
+}
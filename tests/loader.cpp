@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "core.h"
+#include "loader.h"
+#include "test.h"
+
+namespace {
+
+auto write_file(const std::string& name, const std::vector<byte>& bytes)
+    -> std::string {
+  auto path = ::testing::TempDir() + name;
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(bytes.data()),  // NOLINT
+             static_cast<std::streamsize>(bytes.size()));
+  return path;
+}
+
+}  // namespace
+
+TEST(Load, AtOrigin) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    cpu.load_program({0x11, 0x22}, 0xfffe);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.read(0xfffe) == 0x11);
+  HK_TEST(cpu.read(0xffff) == 0x22);
+}
+
+TEST(Load, PastEndThrows) {
+  auto cpu = std::make_unique<cpu6502>();
+  std::vector<byte> bytes(3);
+
+  EXPECT_THROW(cpu->load(0xfffe, bytes.data(), bytes.size()),
+               std::length_error);
+}
+
+TEST(Load, FlushesDecodeCache) {
+  auto cpu = std::make_unique<cpu6502>();
+  decode_cache cache;
+  cpu->attach(&cache);
+
+  // LDA #$01; HLT
+  cpu->load_program({0xa9, 0x01, 0x02});
+  cpu->exec_until_hlt();
+
+  // LDA #$02; HLT
+  cpu->load_program({0xa9, 0x02, 0x02});
+  cpu->PC = 0x1000;
+  cpu->exec_until_hlt();
+
+  EXPECT_EQ(cpu->A, 0x02);
+}
+
+TEST(Loader, Raw) {
+  auto path = write_file("raw.bin", {0xa9, 0x2a, 0x02});
+  auto cpu = std::make_unique<cpu6502>();
+  load_raw(*cpu, path, 0x0800);
+  cpu->PC = 0x0800;
+  cpu->exec_until_hlt();
+
+  EXPECT_EQ(cpu->A, 0x2a);
+}
+
+TEST(Loader, MissingFile) {
+  auto cpu = std::make_unique<cpu6502>();
+
+  EXPECT_THROW(load_raw(*cpu, ::testing::TempDir() + "missing.bin", 0),
+               std::system_error);
+}
+
+TEST(Loader, O65) {
+  auto path = write_file(
+      "program.o65",
+      {0x01, 0x00, 'o', '6', '5', 0x00,  // magic and version
+       0x00, 0x00,                       // mode
+       0x00, 0x20, 0x03, 0x00,           // text at $2000, 3 bytes
+       0x00, 0x30, 0x01, 0x00,           // data at $3000, 1 byte
+       0x00, 0x40, 0x00, 0x00,           // bss
+       0x10, 0x00, 0x00, 0x00,           // zero page
+       0x00, 0x00,                       // stack
+       0x04, 0x00, 'x', 0x00,            // one option
+       0x00,                             // end of options
+       0xad, 0x00, 0x30,                 // text: LDA $3000
+       0x55});                           // data
+
+  auto cpu = std::make_unique<cpu6502>();
+  cpu->PC = load_o65(*cpu, path);
+  cpu->exec();
+
+  EXPECT_EQ(cpu->PC, 0x2003);
+  EXPECT_EQ(cpu->A, 0x55);
+}
+
+TEST(Loader, O65Rejected) {
+  auto cpu = std::make_unique<cpu6502>();
+
+  EXPECT_THROW(load_o65(*cpu, write_file("raw.o65", {0xa9, 0x2a, 0x02})),
+               std::runtime_error);
+  EXPECT_THROW(load_o65(*cpu, write_file("short.o65",
+                                         {0x01, 0x00, 'o', '6', '5', 0x00,
+                                          0x00, 0x00, 0x00, 0x20})),
+               std::runtime_error);
+}
+
+TEST(Loader, Image) {
+  auto path = ::testing::TempDir() + "memory.img";
+  auto saved = std::make_unique<cpu6502>();
+  saved->write(0x0000, 0x01);
+  saved->write(0x8000, 0x02);
+  saved->write(0xffff, 0x03);
+  save_image(*saved, path);
+
+  auto loaded = std::make_unique<bus_cpu6502>();
+  load_image(*loaded, path);
+
+  EXPECT_TRUE(same_state(*saved, *loaded));
+  EXPECT_THROW(load_image(*loaded, write_file("short.img", {0x00})),
+               std::runtime_error);
+}
+
+TEST(Loader, State) {
+  auto path = ::testing::TempDir() + "cpu.state";
+
+  auto saved = std::make_unique<cpu6502>();
+  saved->load_program({0xa9, 0x42, 0x85, 0x10, 0x02});  // LDA #$42; STA $10
+  saved->exec_until_hlt();
+  save_state(*saved, path);
+
+  auto loaded = std::make_unique<cpu6502>();
+  load_state(*loaded, path);
+
+  EXPECT_TRUE(same_state(*saved, *loaded));
+  EXPECT_EQ(loaded->cycles, saved->cycles);
+}
+
+TEST(Loader, MappedRom) {
+  std::vector<byte> bytes(0x180, 0xea);
+  auto path = write_file("rom.bin", bytes);
+
+  paged_memory memory;
+  memory.map_rom(0xe0, map_rom_image(path));
+
+  EXPECT_EQ(memory.read(0xe000), 0xea);
+  EXPECT_EQ(memory.read(0xe17f), 0xea);
+  EXPECT_EQ(memory.read(0xe180), 0x00);
+  EXPECT_EQ(memory.read(0xe200), 0x00);
+  EXPECT_FALSE(memory.writable(0xe1));
+}
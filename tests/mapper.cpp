@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+
+namespace {
+
+// Four ROM banks, each filled with its own number.
+auto numbered_rom() -> rom_image {
+  std::vector<byte> bytes(4 * window_mapper::bank_size);
+  for (std::size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<byte>(i / window_mapper::bank_size);
+  }
+  return rom_image(std::move(bytes));
+}
+
+}  // namespace
+
+TEST(WindowMapper, MapsBanksInOrder) {
+  paged_memory memory;
+  window_mapper mapper(memory, numbered_rom(), 1, {0x40, 0x80}, 0xc0);
+
+  EXPECT_EQ(mapper.banks(), 5U);
+  EXPECT_EQ(memory.read(0x4000), 0);
+  EXPECT_EQ(memory.read(0xbfff), 1);
+  EXPECT_EQ(memory.read(0xc001), 1);
+  EXPECT_EQ(memory.device(0xc0), &mapper);
+  EXPECT_EQ(memory.device(0x40), nullptr);
+}
+
+TEST(WindowMapper, SwitchesOnRegisterWrites) {
+  paged_memory memory;
+  window_mapper mapper(memory, numbered_rom(), 1, {0x40, 0x80}, 0xc0);
+
+  memory.write(0xc001, 3);
+  memory.write(0xc000, 7);
+
+  EXPECT_EQ(memory.read(0x8000), 3);
+  EXPECT_EQ(mapper.bank(0), 2U);
+  EXPECT_EQ(memory.read(0x4000), 2);
+  EXPECT_FALSE(memory.writable(0x80));
+}
+
+TEST(WindowMapper, RamBanksKeepContents) {
+  paged_memory memory;
+  window_mapper mapper(memory, numbered_rom(), 2, {0x80}, 0xc0);
+
+  mapper.select(0, 4);
+  memory.write(0x8123, 0xaa);
+  mapper.select(0, 5);
+  memory.write(0x8123, 0xbb);
+  mapper.select(0, 4);
+
+  EXPECT_EQ(memory.read(0x8123), 0xaa);
+  EXPECT_TRUE(memory.writable(0x80));
+
+  auto copy = memory;
+  copy.write(0x8123, 0xcc);
+
+  EXPECT_EQ(memory.read(0x8123), 0xcc);
+}
+
+TEST(WindowMapper, RejectsBadLayouts) {
+  paged_memory memory;
+
+  EXPECT_THROW(window_mapper(memory, rom_image({0x00}), 0, {0x80}, 0xc0),
+               std::invalid_argument);
+  EXPECT_THROW(window_mapper(memory, numbered_rom(), 0, {0xc1}, 0x00),
+               std::invalid_argument);
+  EXPECT_THROW(window_mapper(memory, numbered_rom(), 0, {0x80}, 0x90),
+               std::invalid_argument);
+}
+
+TEST(WindowMapper, SwitchedByProgram) {
+  auto cpu = std::make_unique<bus_cpu6502>();
+  window_mapper mapper(cpu->memory, numbered_rom(), 0, {0x80}, 0xc0);
+
+  // LDX #$02; STX $c000; LDA $8000; HLT
+  cpu->load_program({0xa2, 0x02, 0x8e, 0x00, 0xc0, 0xad, 0x00, 0x80, 0x02});
+  cpu->exec_until_hlt();
+
+  EXPECT_EQ(cpu->A, 2);
+  EXPECT_EQ(mapper.bank(0), 2U);
+}
+
+TEST(WindowMapper, SwitchDropsDecodedCode) {
+  // At $8000 in bank b: LDA $0010 + $10 * b; INX; STX $c000; then bank 0
+  // stops on HLT and bank 1 jumps back to $8000, now in bank 0... or in
+  // bank 1's decoded code, if the switch left it cached.
+  std::vector<byte> bytes(2 * window_mapper::bank_size);
+  for (std::size_t bank = 0; bank < 2; bank++) {
+    auto* code = &bytes[bank * window_mapper::bank_size];
+    const std::vector<byte> window = {
+        0xad, static_cast<byte>(0x10 + 0x10 * bank), 0x00, 0xe8, 0x8e, 0x00,
+        0xc0, static_cast<byte>(bank == 0 ? 0x02 : 0x4c), 0x00, 0x80};
+    std::copy(window.begin(), window.end(), code);
+  }
+
+  auto cpu = std::make_unique<bus_cpu6502>();
+  window_mapper mapper(cpu->memory, rom_image(std::move(bytes)), 0, {0x80},
+                       0xc0);
+  bus_cpu6502::decode_cache cache;
+  cpu->attach(&cache);
+  cpu->write(0x0010, 0x11);
+  cpu->write(0x0020, 0x22);
+
+  // JMP $8000
+  cpu->load_program({0x4c, 0x00, 0x80});
+  cpu->exec_n(4);
+  EXPECT_EQ(cpu->A, 0x11);
+  EXPECT_EQ(mapper.bank(0), 1U);
+
+  cpu->exec_n(4);
+  EXPECT_EQ(cpu->A, 0x22);
+  EXPECT_EQ(mapper.bank(0), 0U);
+  EXPECT_EQ(cpu->PC, 0x8007);
+  EXPECT_EQ(cpu->read(cpu->PC), 0x02);
+}
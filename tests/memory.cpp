@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+
 #include "core.h"
 #include "test.h"
 
@@ -57,3 +59,57 @@ TEST(MemoryAPI, LoadProgram) {
   HK_TEST(cpu.read(0x100e) == 0xee);
   HK_TEST(cpu.read(0x100f) == 0xff);
 }
+
+TEST(TrackedMemory, MarksWrittenPages) {
+  constexpr auto memory = [] {
+    tracked_memory memory;
+    memory.write(0x00ff, 0x01);
+    memory.write(0x4000, 0x02);
+    memory.write(0xffff, 0x03);
+    return memory;
+  }();
+
+  HK_TEST(memory.is_dirty(0x00));
+  HK_TEST(!memory.is_dirty(0x01));
+  HK_TEST(memory.is_dirty(0x40));
+  HK_TEST(memory.is_dirty(0xff));
+  HK_TEST(memory.dirty_pages()[0] == 1);
+  HK_TEST(memory.dirty_pages()[1] == 1);
+  HK_TEST(memory.dirty_pages()[3] == std::uint64_t{1} << 63);
+}
+
+TEST(TrackedMemory, RestoresDirtyPages) {
+  constexpr auto memory = [] {
+    tracked_memory baseline;
+    baseline.write(0x1000, 0x11);
+    baseline.clean();
+
+    auto memory = baseline;
+    memory.write(0x1000, 0x22);
+    memory.write(0x20ff, 0x33);
+    memory.restore(baseline);
+    return memory;
+  }();
+
+  HK_TEST(memory.read(0x1000) == 0x11);
+  HK_TEST(memory.read(0x20ff) == 0x00);
+  HK_TEST(!memory.is_dirty(0x10));
+  HK_TEST(!memory.is_dirty(0x20));
+}
+
+TEST(TrackedMemory, RestoresCpu) {
+  // LDX #$00; TXA; STA $2000,X; INX; BNE -7; HLT
+  constexpr auto restored = [] {
+    tracked_cpu6502 cpu;
+    cpu.load_program({0xa2, 0x00, 0x8a, 0x9d, 0x00, 0x20, 0xe8, 0xd0, 0xf9,
+                      0x02});
+    cpu.memory.clean();
+
+    auto baseline = cpu;
+    cpu.exec_until_hlt();
+    cpu.restore(baseline);
+    return same_state(cpu, baseline) && cpu.cycles == 0;
+  }();
+
+  HK_TEST(restored);
+}
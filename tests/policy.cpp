@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+using traced_cpu =
+    basic_cpu6502<flat_memory, unchecked, ring_trace<4>, cycle_timing>;
+using untimed_cpu =
+    basic_cpu6502<flat_memory, unchecked, no_trace, no_timing>;
+using short_undo_cpu =
+    basic_cpu6502<flat_memory, unchecked, undo_trace<8, 1>, cycle_timing>;
+
+// LDX #$00; loop: TXA; STA $2000,X; INX; BNE loop; HLT
+template <typename Cpu>
+auto load_fill(Cpu& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0x8a, 0x9d, 0x00, 0x20, 0xe8, 0xd0, 0xf9,
+                    0x02});
+  for (int addr = 0x2000; addr < 0x2100; addr++) {
+    cpu.write(addr, 0xee);
+  }
+}
+
+// LDX #$00; INX; INX; INX; INX; HLT
+template <typename Cpu>
+constexpr auto run() -> Cpu {
+  Cpu cpu;
+  cpu.load_program({0xa2, 0x00, 0xe8, 0xe8, 0xe8, 0xe8, 0x02});
+  cpu.exec_until_hlt();
+  return cpu;
+}
+
+}  // namespace
+
+TEST(Checked, RunsDocumentedOpcodes) {
+  constexpr auto checked_cpu = run<debug_cpu6502>();
+  constexpr auto plain = run<cpu6502>();
+
+  HK_TEST(same_state(checked_cpu, plain));
+  HK_TEST(checked_cpu.cycles == plain.cycles);
+}
+
+TEST(Checked, ThrowsOnUndocumented) {
+  auto cpu = std::make_unique<debug_cpu6502>();
+  cpu->load_program({0xea, 0x03});
+  cpu->exec();
+
+  EXPECT_THROW(cpu->exec(), std::runtime_error);
+}
+
+TEST(Checked, ThrowsThroughDecodeCache) {
+  auto cpu = std::make_unique<debug_cpu6502>();
+  auto cache = std::make_unique<debug_cpu6502::decode_cache>();
+  cpu->attach(cache.get());
+  cpu->load_program({0x03});
+
+  EXPECT_THROW(cpu->exec(), std::runtime_error);
+}
+
+TEST(Unchecked, RunsUndocumentedAsNop) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    cpu.load_program({0x03});
+    cpu.exec();
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1001);
+}
+
+TEST(RingTrace, KeepsLastEntries) {
+  constexpr auto cpu = run<traced_cpu>();
+
+  HK_TEST(cpu.trace.total == 5);
+  HK_TEST(cpu.trace.size() == 4);
+  HK_TEST(cpu.trace[0].pc == 0x1002);
+  HK_TEST(cpu.trace[0].X == 0x00);
+  HK_TEST(cpu.trace.back().pc == 0x1005);
+  HK_TEST(cpu.trace.back().opcode == 0xe8);
+  HK_TEST(cpu.trace.back().X == 0x03);
+  HK_TEST(cpu.trace.back().cycles == 8);
+}
+
+TEST(RingTrace, NotFull) {
+  constexpr auto cpu = [] {
+    traced_cpu cpu;
+    cpu.load_program({0xa2, 0x05, 0xe8});
+    cpu.exec_n(2);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.trace.size() == 2);
+  HK_TEST(cpu.trace[0].pc == 0x1000);
+  HK_TEST(cpu.trace[1].pc == 0x1002);
+  HK_TEST(cpu.trace[1].X == 0x05);
+}
+
+TEST(NoTiming, LeavesCyclesAtZero) {
+  constexpr auto cpu = run<untimed_cpu>();
+
+  HK_TEST(cpu.cycles == 0);
+  HK_TEST(same_state(cpu, run<cpu6502>()));
+}
+
+TEST(UndoTrace, StepsBack) {
+  constexpr auto cpu = [] {
+    undo_cpu6502 cpu;
+    cpu.load_program({0xa2, 0x05, 0x8e, 0x00, 0x20, 0xe8, 0x02});
+    cpu.exec_n(3);  // LDX #$05; STX $2000; INX
+    cpu.step_back(2);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1002);
+  HK_TEST(cpu.X == 0x05);
+  HK_TEST(cpu.read(0x2000) == 0x00);
+  HK_TEST(cpu.cycles == 2);
+  HK_TEST(cpu.trace.total == 1);
+}
+
+TEST(UndoTrace, ReturnsToEarlierState) {
+  auto cpu = std::make_unique<undo_cpu6502>();
+  load_fill(*cpu);
+  cpu->exec_n(100);
+  cpu->write(0x10, 0x00);  // through write(), undone with the 100th
+  auto earlier = std::make_unique<undo_cpu6502>(*cpu);
+
+  cpu->exec_n(500);
+  EXPECT_EQ(cpu->step_back(500), 500U);
+  EXPECT_TRUE(same_state(*cpu, *earlier));
+  EXPECT_EQ(cpu->cycles, earlier->cycles);
+
+  // And runs on from there as it did before.
+  cpu->exec_n(500);
+  earlier->exec_n(500);
+  EXPECT_TRUE(same_state(*cpu, *earlier));
+}
+
+TEST(UndoTrace, StopsAtLoad) {
+  constexpr auto cpu = [] {
+    undo_cpu6502 cpu;
+    cpu.load_program({0xa2, 0x05, 0x8e, 0x00, 0x20, 0xe8, 0x02});
+    cpu.exec_n(2);  // LDX #$05; STX $2000
+    std::array<byte, 2> data = {0x11, 0x22};
+    cpu.load(0x2000, data.data(), data.size());
+    cpu.exec_n(1);  // INX
+    cpu.step_back(3);
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1005);
+  HK_TEST(cpu.X == 0x05);
+  HK_TEST(cpu.read(0x2000) == 0x11);
+  HK_TEST(cpu.read(0x2001) == 0x22);
+  HK_TEST(cpu.trace.size() == 0);
+}
+
+TEST(UndoTrace, StopsAtWhatItKept) {
+  auto cpu = std::make_unique<short_undo_cpu>();
+  load_fill(*cpu);
+  cpu->exec_n(20);
+
+  // 8 instructions are kept but only the last write, of the 19th: the
+  // 15th wrote before it and can no longer be undone.
+  auto kept = cpu->trace.size();
+  EXPECT_EQ(kept, 5U);
+
+  auto pc = cpu->PC;
+  EXPECT_EQ(cpu->step_back(100), kept);
+  EXPECT_EQ(cpu->step_back(), 0U);
+  EXPECT_NE(cpu->PC, pc);
+  EXPECT_EQ(cpu->trace.size(), 0U);
+
+  // Runs forward again from where it stopped.
+  auto plain = std::make_unique<cpu6502>();
+  load_fill(*plain);
+  plain->exec_n(static_cast<int>(20 - kept));
+  EXPECT_TRUE(same_state(*cpu, *plain));
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "core.h"
+
+namespace {
+
+// Different bytes on every read, like a timer or a serial port.
+class noise : public bus_device {
+ public:
+  auto read(word addr) -> byte override {
+    m_state = static_cast<byte>(m_state * 5 + 1);
+    return static_cast<byte>(m_state ^ addr);
+  }
+
+  auto write(word /*addr*/, byte data) -> void override { m_state = data; }
+
+ private:
+  byte m_state = 0x17;
+};
+
+// LDX #$00; LDA $c000; STA $2000,X; INX; BNE -9; HLT, with an interrupt
+// handler at $3000: INC $10; LDA $c001; STA $11; RTI.
+auto load(bus_cpu6502& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0xad, 0x00, 0xc0, 0x9d, 0x00, 0x20, 0xe8,
+                    0xd0, 0xf7, 0x02});
+  cpu.load_program({0xe6, 0x10, 0xad, 0x01, 0xc0, 0x85, 0x11, 0x40}, 0x3000);
+  cpu.write16(0xfffe, 0x3000);
+  cpu.write16(0xfffa, 0x3000);
+  cpu.SP = 0xff;
+}
+
+auto halted(const bus_cpu6502& cpu) -> bool {
+  return cpu.read(cpu.PC) == bus_cpu6502::hlt_opcode;
+}
+
+}  // namespace
+
+TEST(Interrupt, Irq) {
+  auto cpu = std::make_unique<cpu6502>();
+  cpu->write16(0xfffe, 0x3000);
+  cpu->SP = 0xff;
+  cpu->PC = 0x1234;
+  cpu->C() = true;
+
+  EXPECT_TRUE(cpu->irq());
+  EXPECT_EQ(cpu->PC, 0x3000);
+  EXPECT_EQ(cpu->SP, 0xfc);
+  EXPECT_EQ(cpu->read16(0x01fe), 0x1234);
+  EXPECT_EQ(cpu->read(0x01fd) & 0b00010001, 0b00000001);
+  EXPECT_TRUE(cpu->I());
+  EXPECT_EQ(cpu->cycles, 7U);
+
+  EXPECT_FALSE(cpu->irq());
+  EXPECT_EQ(cpu->PC, 0x3000);
+
+  cpu->load_program({0x40}, 0x3000);  // RTI
+  cpu->exec();
+  EXPECT_EQ(cpu->PC, 0x1234);
+  EXPECT_FALSE(cpu->I());
+  EXPECT_TRUE(cpu->C());
+}
+
+TEST(Interrupt, NmiIgnoresI) {
+  auto cpu = std::make_unique<cpu6502>();
+  cpu->write16(0xfffa, 0x4000);
+  cpu->I() = true;
+
+  cpu->nmi();
+  EXPECT_EQ(cpu->PC, 0x4000);
+}
+
+TEST(Replay, ReproducesRun) {
+  noise device;
+
+  auto recorded = std::make_unique<bus_cpu6502>();
+  load(*recorded);
+  input_recorder recorder(recorded->cycles);
+  recorded->memory.map_device(0xc0, 1, recorder.wrap(device));
+
+  for (std::uint64_t next = 100; !halted(*recorded); recorded->exec()) {
+    if (recorded->cycles >= next) {
+      if (next % 3 == 0) {
+        recorder.nmi(*recorded);
+      } else {
+        recorder.irq(*recorded);
+      }
+      next += 97;
+    }
+  }
+
+  auto replayed = std::make_unique<bus_cpu6502>();
+  load(*replayed);
+  input_replayer replayer(recorder.log, replayed->cycles);
+  replayed->memory.map_device(0xc0, 1, replayer);
+
+  while (!halted(*replayed)) {
+    replayer.exec(*replayed);
+  }
+  EXPECT_TRUE(replayer.done());
+
+  // same_state() reads every page, devices included.
+  recorded->memory.map_ram(0xc0, 1);
+  replayed->memory.map_ram(0xc0, 1);
+  EXPECT_TRUE(same_state(*recorded, *replayed));
+  EXPECT_EQ(replayed->cycles, recorded->cycles);
+  EXPECT_GT(replayed->read(0x10), 10);
+}
+
+TEST(Replay, DetectsDivergence) {
+  noise device;
+
+  auto recorded = std::make_unique<bus_cpu6502>();
+  load(*recorded);
+  input_recorder recorder(recorded->cycles);
+  recorded->memory.map_device(0xc0, 1, recorder.wrap(device));
+  recorded->exec_until_hlt();
+
+  auto replayed = std::make_unique<bus_cpu6502>();
+  load(*replayed);
+  replayed->write(0x1003, 0x01);  // LDA $c001
+  input_replayer replayer(recorder.log, replayed->cycles);
+  replayed->memory.map_device(0xc0, 1, replayer);
+
+  replayer.exec(*replayed);
+  EXPECT_THROW(replayer.exec(*replayed), std::runtime_error);
+}
+
+TEST(Replay, LogEncoding) {
+  input_log log;
+  log.append({10, input_event::kind::read, 0xc000, 0x42});
+  log.append({17, input_event::kind::read, 0xc001, 0x43});
+  log.append({100'000, input_event::kind::irq});
+  EXPECT_EQ(log.bytes.size(), 5 + 5 + 4);
+
+  std::vector<byte> copy = log.bytes;
+  input_reader reader(copy.data(), copy.size());
+  auto first = reader.next();
+  EXPECT_EQ(first.stamp, 10U);
+  EXPECT_EQ(first.addr, 0xc000);
+  EXPECT_EQ(first.data, 0x42);
+  EXPECT_EQ(reader.next().stamp, 17U);
+
+  auto irq = reader.next();
+  EXPECT_EQ(irq.what, input_event::kind::irq);
+  EXPECT_EQ(irq.stamp, 100'000U);
+  EXPECT_TRUE(reader.done());
+
+  copy.pop_back();
+  EXPECT_THROW(
+      {
+        input_reader truncated(copy.data(), copy.size());
+        truncated.next();
+        truncated.next();
+      },
+      std::runtime_error);
+}
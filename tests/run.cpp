@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <tuple>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+// LDA #$2a; STA $10; LDX #$07; STX $11; HLT
+constexpr std::array<byte, 9> store = {0xa9, 0x2a, 0x85, 0x10, 0xa2,
+                                       0x07, 0x86, 0x11, 0x02};
+
+// Same program as a C array, loaded at $c000.
+constexpr byte store_rom[] = {0xa9, 0x2a, 0x85, 0x10, 0xa2,
+                              0x07, 0x86, 0x11, 0x02};
+
+}  // namespace
+
+TEST(RunConstexpr, Registers) {
+  constexpr auto result = run_constexpr<store, 0x1000, registers>();
+  constexpr auto regs = std::get<0>(result);
+
+  HK_TEST(regs.A == 0x2a);
+  HK_TEST(regs.X == 0x07);
+  HK_TEST(regs.PC == 0x1009);
+  HK_TEST(regs.P == 0x20);
+  HK_TEST(regs.cycles == 2 + 3 + 2 + 3);
+}
+
+TEST(RunConstexpr, MemoryRange) {
+  constexpr auto result = run_constexpr<store, 0x1000, memory_range<0x10, 2>>();
+  constexpr auto range = std::get<0>(result);
+
+  HK_TEST(range[0] == 0x2a);
+  HK_TEST(range[1] == 0x07);
+  HK_TEST(range.read16(0) == 0x072a);
+  HK_TEST(decltype(range)::address == 0x10);
+}
+
+TEST(RunConstexpr, Origin) {
+  constexpr auto result =
+      run_constexpr<store_rom, 0xc000, registers, memory_range<0xc000, 1>>();
+
+  HK_TEST(std::get<0>(result).PC == 0xc009);
+  HK_TEST(std::get<1>(result)[0] == 0xa9);
+}
+
+TEST(RunConstexpr, OnlyKeepsWhatIsAsked) {
+  using result =
+      decltype(run_constexpr<store, 0x1000, memory_range<0x10, 2>>());
+
+  HK_TEST(sizeof(result) == 2);
+  HK_TEST(sizeof(result) < sizeof(cpu6502));
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core.h"
+
+TEST(Scheduler, ResumesInTimeOrder) {
+  scheduler board;
+  std::vector<std::pair<std::uint64_t, int>> resumed;
+
+  for (int id = 0; id < 3; id++) {
+    auto period = static_cast<std::uint64_t>(3 + 2 * id);  // 3, 5, 7
+    board.add(
+        [&, id, period](std::uint64_t now) {
+          resumed.emplace_back(now, id);
+          return now + period;
+        },
+        period);
+  }
+  board.run_until(16);
+
+  std::vector<std::pair<std::uint64_t, int>> expected = {
+      {3, 0}, {5, 1}, {6, 0}, {7, 2}, {9, 0}, {10, 1}, {12, 0}, {14, 2},
+      {15, 0}, {15, 1}};
+  EXPECT_EQ(resumed, expected);
+  EXPECT_EQ(board.resumes, expected.size());
+  EXPECT_EQ(board.now, 15U);
+}
+
+TEST(Scheduler, DropsDoneTasks) {
+  scheduler board;
+  int runs = 0;
+  board.add([&](std::uint64_t now) {
+    return ++runs < 3 ? now + 1 : scheduler::done;
+  });
+
+  board.run_until(100);
+  EXPECT_EQ(runs, 3);
+  EXPECT_TRUE(board.empty());
+}
+
+TEST(Scheduler, RejectsThePast) {
+  scheduler board;
+  board.add([](std::uint64_t now) { return now - 1; }, 10);
+
+  EXPECT_THROW(board.run_until(100), std::runtime_error);
+}
+
+TEST(Scheduler, CpuQuanta) {
+  // LDX #$00; loop: INX; JMP loop, 5 cycles per iteration.
+  auto by_cycles = std::make_unique<cpu6502>();
+  auto by_instructions = std::make_unique<cpu6502>();
+  for (auto* cpu : {by_cycles.get(), by_instructions.get()}) {
+    cpu->load_program({0xa2, 0x00, 0xe8, 0x4c, 0x02, 0x10});
+  }
+
+  using task = cpu_task<cpu6502>;
+  task cycles_task(*by_cycles, 100);
+  task instructions_task(*by_instructions, 10, task::unit::instructions);
+
+  scheduler board;
+  board.add(cycles_task);
+  board.add(instructions_task);
+  board.run_until(1000);
+
+  // Both ran up to the first quantum ending at 1000 or later.
+  EXPECT_GE(by_cycles->cycles, 1000U);
+  EXPECT_LT(by_cycles->cycles, 1100U);
+  EXPECT_GE(by_instructions->cycles, 1000U);
+  EXPECT_LT(by_instructions->cycles, 1000U + 10 * 3);
+  EXPECT_EQ(board.resumes, 10U + 1000 / 25 + 1);
+}
+
+TEST(Scheduler, DeviceInterruptsCpu) {
+  // loop: JMP loop, with an interrupt handler at $3000: INC $10; RTI.
+  auto cpu = std::make_unique<cpu6502>();
+  cpu->load_program({0x4c, 0x00, 0x10});
+  cpu->load_program({0xe6, 0x10, 0x40}, 0x3000);
+  cpu->write16(0xfffe, 0x3000);
+  cpu->SP = 0xff;
+
+  cpu_task<cpu6502> running(*cpu, 20);
+
+  scheduler board;
+  board.add(running);
+  board.add(
+      [&](std::uint64_t now) {
+        cpu->irq();
+        return now + 500;
+      },
+      500);
+  board.run_until(5000);
+
+  EXPECT_EQ(cpu->read(0x10), 9);
+}
+
+TEST(Scheduler, CpuCyclesCountOnlyWhatRan) {
+  // loop: JMP loop, 3 cycles per instruction.
+  auto cpu = std::make_unique<cpu6502>();
+  cpu->load_program({0x4c, 0x00, 0x10});
+
+  cpu_task<cpu6502> running(*cpu, 30);
+
+  scheduler board;
+  board.add(running, 1000);
+  board.run_until(1100);
+
+  // Added at 1000, it ran 4 quanta of 30 cycles from there.
+  EXPECT_EQ(cpu->cycles, 120U);
+  EXPECT_EQ(running.time(), 1120U);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "core.h"
+
+namespace {
+
+// Records writes and answers reads with the low byte of the address.
+class echo_device : public bus_device {
+ public:
+  auto read(word addr) -> byte override {
+    reads++;
+    return static_cast<byte>(addr);
+  }
+
+  auto write(word /*addr*/, byte /*data*/) -> void override { writes++; }
+
+  int reads = 0;
+  int writes = 0;
+};
+
+// LDX #$00; TXA; STA $2000,X; INX; BNE -7; SEC; HLT
+auto start(cpu6502& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0x8a, 0x9d, 0x00, 0x20, 0xe8, 0xd0, 0xf9,
+                    0x38, 0x02});
+  cpu.exec_n(300);
+  cpu.SP = 0xfd;
+}
+
+}  // namespace
+
+TEST(Snapshot, RoundTrip) {
+  auto cpu = std::make_unique<cpu6502>();
+  start(*cpu);
+
+  auto saved = save_state(*cpu);
+  auto loaded = std::make_unique<cpu6502>();
+  load_state(*loaded, saved.data(), saved.size());
+
+  EXPECT_TRUE(same_state(*cpu, *loaded));
+  EXPECT_EQ(loaded->cycles, cpu->cycles);
+
+  cpu->exec_until_hlt();
+  loaded->exec_until_hlt();
+  EXPECT_TRUE(same_state(*cpu, *loaded));
+  EXPECT_TRUE(loaded->C());
+}
+
+TEST(Snapshot, ElidesZeroPages) {
+  auto cpu = std::make_unique<cpu6502>();
+  auto empty = save_state(*cpu);
+  EXPECT_EQ(empty.size(), snapshot::header_size + 32);
+
+  start(*cpu);
+  // The program's page and the first page it fills.
+  EXPECT_EQ(save_state(*cpu).size(), snapshot::header_size + 32 + 2 * 0x100);
+}
+
+TEST(Snapshot, StreamsAcrossMemoryModels) {
+  auto cpu = std::make_unique<cpu6502>();
+  start(*cpu);
+
+  std::stringstream stream;
+  save_state(*cpu, stream);
+
+  auto tracked = std::make_unique<tracked_cpu6502>();
+  tracked->write(0x3000, 0x42);
+  load_state(*tracked, stream);
+
+  EXPECT_TRUE(same_state(*cpu, *tracked));
+  EXPECT_EQ(tracked->read(0x3000), 0x00);
+}
+
+TEST(Snapshot, RejectsBadInput) {
+  auto cpu = std::make_unique<cpu6502>();
+  start(*cpu);
+  auto saved = save_state(*cpu);
+  auto target = std::make_unique<cpu6502>();
+
+  auto bad_magic = saved;
+  bad_magic[0] = 'x';
+  EXPECT_THROW(load_state(*target, bad_magic.data(), bad_magic.size()),
+               std::runtime_error);
+
+  auto short_header = saved;
+  short_header[6] = static_cast<byte>(snapshot::header_size - 1);
+  EXPECT_THROW(load_state(*target, short_header.data(), short_header.size()),
+               std::runtime_error);
+  EXPECT_EQ(target->PC, 0x1000);
+
+  EXPECT_THROW(load_state(*target, saved.data(), saved.size() - 1),
+               std::runtime_error);
+}
+
+TEST(Snapshot, SkipsLaterHeaderFields) {
+  auto cpu = std::make_unique<cpu6502>();
+  start(*cpu);
+  auto saved = save_state(*cpu);
+
+  // A header two bytes longer, as a later version might write.
+  saved[4] = snapshot::version + 1;
+  saved[6] = static_cast<byte>(snapshot::header_size + 2);
+  saved.insert(saved.begin() + snapshot::header_size, {0xaa, 0xbb});
+
+  auto loaded = std::make_unique<cpu6502>();
+  load_state(*loaded, saved.data(), saved.size());
+  EXPECT_TRUE(same_state(*cpu, *loaded));
+}
+
+TEST(Snapshot, LeavesDevicesAndRomAlone) {
+  echo_device device;
+  auto rom = rom_image(std::vector<byte>(0x100, 0xea));
+  auto map = [&](bus_cpu6502& cpu) {
+    cpu.memory.map_device(0xd0, 1, device);
+    cpu.memory.map_rom(0xf0, rom, &device);
+  };
+
+  auto cpu = std::make_unique<bus_cpu6502>();
+  map(*cpu);
+  cpu->write(0x0300, 0x42);
+  auto saved = save_state(*cpu);
+  EXPECT_EQ(device.reads, 0);
+
+  auto loaded = std::make_unique<bus_cpu6502>();
+  map(*loaded);
+  loaded->write(0x0400, 0x01);
+  load_state(*loaded, saved.data(), saved.size());
+
+  EXPECT_EQ(device.reads, 0);
+  EXPECT_EQ(device.writes, 0);
+  EXPECT_EQ(loaded->read(0x0300), 0x42);
+  EXPECT_EQ(loaded->read(0x0400), 0x00);
+  EXPECT_EQ(loaded->read(0xf000), 0xea);
+  EXPECT_EQ(loaded->memory.device(0xd0), &device);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "test.h"
+
+namespace {
+
+// LDX #$00; INX; INX; INX; HLT; NOP
+constexpr auto load(cpu6502& cpu) -> void {
+  cpu.load_program({0xa2, 0x00, 0xe8, 0xe8, 0xe8, 0x02, 0xea});
+}
+
+}  // namespace
+
+TEST(Until, Hlt) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    load(cpu);
+    cpu.exec_until<cpu6502::until_hlt>();
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1005);
+  HK_TEST(cpu.X == 0x03);
+}
+
+TEST(Until, HltStepsOver) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    load(cpu);
+    cpu.exec_until_hlt();
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1006);
+  HK_TEST(cpu.X == 0x03);
+}
+
+TEST(Until, Pc) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    load(cpu);
+    cpu.exec_until<cpu6502::until_pc<0x1004>>();
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1004);
+  HK_TEST(cpu.X == 0x02);
+}
+
+TEST(Until, Count) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    load(cpu);
+    cpu.exec_until(cpu6502::until_count{3});
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1004);
+  HK_TEST(cpu.X == 0x02);
+}
+
+TEST(Until, Cycles) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    load(cpu);
+    // 2 cycles per instruction, so 5 rounds up to the third
+    cpu.exec_until(cpu6502::until_cycles{5});
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1004);
+  HK_TEST(cpu.cycles == 6);
+}
+
+TEST(Until, Lambda) {
+  constexpr auto cpu = [] {
+    cpu6502 cpu;
+    load(cpu);
+    cpu.exec_until([](const cpu6502& cpu) { return cpu.X == 0x01; });
+    return cpu;
+  }();
+
+  HK_TEST(cpu.PC == 0x1003);
+}